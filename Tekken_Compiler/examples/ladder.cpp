@@ -0,0 +1,110 @@
+#include "../include/TekkenLadder.h"
+
+BEGIN_GAME
+
+CREATE ABILITY {
+    NAME: "Quick_Jab",
+    ACTION: START
+        DAMAGE DEFENDER 10
+    END
+}
+
+CREATE ABILITY {
+    NAME: "Power_Slam",
+    ACTION: START
+        DAMAGE DEFENDER 25
+    END
+}
+
+CREATE ABILITY {
+    NAME: "Meditate",
+    ACTION: START
+        HEAL ATTACKER 15
+    END
+}
+
+CREATE ABILITY {
+    NAME: "Bleeding_Bite",
+    ACTION: START
+        FOR 3 ROUNDS DO
+            DAMAGE DEFENDER 8
+        END
+    END
+}
+
+CREATE ABILITY {
+    NAME: "Stun_Gun",
+    ACTION: START
+        IF NOT(HAS_STATUS(DEFENDER, STUN)) DO
+            APPLY DEFENDER STUN 1
+        ELSE
+            DAMAGE DEFENDER 12
+        END
+    END
+}
+
+CREATE ABILITY {
+    NAME: "Venom_Fang",
+    ACTION: START
+        APPLY DEFENDER POISON 3
+        APPLY ATTACKER BUFF 2
+    END
+}
+
+CREATE ABILITY {
+    NAME: "Iron_Guard",
+    ACTION: START
+        APPLY ATTACKER SHIELD 2
+    END
+}
+
+CREATE FIGHTER {
+    NAME: "Ryu",
+    TYPE: "Rushdown",
+    HP: 100
+}
+
+CREATE FIGHTER {
+    NAME: "Zangief",
+    TYPE: "Grappler",
+    HP: 120
+}
+
+CREATE FIGHTER {
+    NAME: "Jack-6",
+    TYPE: "Heavy",
+    HP: 90
+}
+
+CREATE FIGHTER {
+    NAME: "Lili",
+    TYPE: "Evasive",
+    HP: 95
+}
+
+DEAR "Ryu" LEARN [
+    ABILITY_NAME(Quick_Jab)
+    ABILITY_NAME(Meditate)
+    ABILITY_NAME(Stun_Gun)
+]
+
+DEAR "Zangief" LEARN [
+    ABILITY_NAME(Power_Slam)
+    ABILITY_NAME(Meditate)
+]
+
+DEAR "Jack-6" LEARN [
+    ABILITY_NAME(Power_Slam)
+    ABILITY_NAME(Bleeding_Bite)
+    ABILITY_NAME(Iron_Guard)
+]
+
+DEAR "Lili" LEARN [
+    ABILITY_NAME(Quick_Jab)
+    ABILITY_NAME(Bleeding_Bite)
+    ABILITY_NAME(Venom_Fang)
+]
+
+LADDER(20000, 30)
+
+END_GAME
@@ -0,0 +1,76 @@
+#include "../include/TekkenRoster.h"
+
+#include <chrono>
+#include <cstdio>
+
+// Startup cost of a large roster: the runtime work the CREATE FIGHTER /
+// DEAR ... LEARN macros do versus LOAD_ROSTER on a precompiled image, plus
+// the optional copy of the image into the registries.
+
+static double msSince(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char** argv) {
+    const int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const std::string imagePath = argc > 2 ? argv[2] : "roster_bench.tkr";
+    const char* types[] = {"Rushdown", "Grappler", "Heavy", "Evasive"};
+    const char* moves[] = {"Quick_Jab", "Power_Slam", "Meditate", "Bleeding_Bite"};
+
+    std::ostringstream src;
+    src << "ability Quick_Jab\n damage defender 10\nend\n"
+        << "ability Power_Slam\n damage defender 25\nend\n"
+        << "ability Meditate\n heal attacker 15\nend\n"
+        << "ability Bleeding_Bite\n for 3\n  damage defender 8\n end\nend\n";
+    for(int i = 0; i < count; ++i) {
+        src << "fighter Fighter_" << i << " " << types[i % 4] << " " << (80 + i % 60) << "\n"
+            << "learn Fighter_" << i << " " << moves[i % 4] << " " << moves[(i + 1) % 4] << " " << moves[(i + 2) % 4] << "\n";
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::istringstream in(src.str());
+    std::vector<char> image = compileRoster(in);
+    {
+        std::ofstream out(imagePath, std::ios::binary);
+        out.write(image.data(), static_cast<std::streamsize>(image.size()));
+    }
+    double compileMs = msSince(t0);
+
+    // Macro path: what the expanded CREATE / DEAR statements execute.
+    resetGame();
+    t0 = std::chrono::steady_clock::now();
+    for(int m = 0; m < 4; ++m) regAbility(moves[m], [](Fighter&, Fighter&, int, ActionContext&) {});
+    for(int i = 0; i < count; ++i) {
+        std::string n = "Fighter_" + std::to_string(i);
+        regFighter(Fighter(n, types[i % 4], 80 + i % 60));
+        Fighter& f = getFighter(n);
+        for(int k = 0; k < 3; ++k) f.addAbility(moves[(i + k) % 4]);
+    }
+    double macroMs = msSince(t0);
+    resetGame();
+
+    // Image path: what LOAD_ROSTER + DUEL run before the first round, i.e.
+    // map and validate the image, then resolve the two selected fighters.
+    t0 = std::chrono::steady_clock::now();
+    const RosterImage& img = loadRoster(imagePath);
+    Fighter f1, f2;
+    bool found = g_duelSource().find("Fighter_" + std::to_string(count / 2), f1)
+              && g_duelSource().find("Fighter_" + std::to_string(count - 1), f2);
+    double imageMs = msSince(t0);
+
+    // Copying the image into the registries, needed only by the modes that
+    // read g_fighters() (LADDER, TOURNAMENT, STATS, TRAIN_POLICY).
+    t0 = std::chrono::steady_clock::now();
+    installRoster(img);
+    double installMs = msSince(t0);
+    resetGame();
+
+    std::printf("Fighters:          %d\n", count);
+    std::printf("Image size:        %zu bytes\n", image.size());
+    std::printf("Compile step:      %.2f ms\n", compileMs);
+    std::printf("Macro startup:     %.2f ms\n", macroMs);
+    std::printf("LOAD_ROSTER+DUEL:  %.3f ms (lookup %s)\n", imageMs, found ? "ok" : "failed");
+    std::printf("installRoster:     %.2f ms\n", installMs);
+    std::remove(imagePath.c_str());
+    return found ? 0 : 1;
+}
@@ -0,0 +1,13 @@
+#include "../include/TekkenRoster.h"
+
+#ifndef TEKKEN_ROSTER_IMAGE
+#define TEKKEN_ROSTER_IMAGE "example.tkr"
+#endif
+
+BEGIN_GAME
+
+LOAD_ROSTER(TEKKEN_ROSTER_IMAGE)
+
+DUEL
+
+END_GAME
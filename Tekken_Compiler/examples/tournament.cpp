@@ -0,0 +1,94 @@
+#include "../include/TekkenShard.h"
+
+BEGIN_GAME
+
+CREATE ABILITY {
+    NAME: "Quick_Jab",
+    ACTION: START
+        DAMAGE DEFENDER 10
+    END
+}
+
+CREATE ABILITY {
+    NAME: "Power_Slam",
+    ACTION: START
+        DAMAGE DEFENDER 25
+    END
+}
+
+CREATE ABILITY {
+    NAME: "Meditate",
+    ACTION: START
+        HEAL ATTACKER 15
+    END
+}
+
+CREATE ABILITY {
+    NAME: "Stun_Gun",
+    ACTION: START
+        IF NOT(HAS_STATUS(DEFENDER, STUN)) DO
+            APPLY DEFENDER STUN 1
+        ELSE
+            DAMAGE DEFENDER 12
+        END
+    END
+}
+
+CREATE ABILITY {
+    NAME: "Give_Autographs",
+    ACTION: START
+        TAG DEFENDER ---α
+        AFTER 2 ROUNDS DO
+            TAG DEFENDER _
+        END
+    END
+}
+
+CREATE FIGHTER {
+    NAME: "Ryu",
+    TYPE: "Rushdown",
+    HP: 100
+}
+
+CREATE FIGHTER {
+    NAME: "Zangief",
+    TYPE: "Grappler",
+    HP: 120
+}
+
+CREATE FIGHTER {
+    NAME: "Jack-6",
+    TYPE: "Heavy",
+    HP: 90
+}
+
+CREATE FIGHTER {
+    NAME: "Lee",
+    TYPE: "Evasive",
+    HP: 95
+}
+
+DEAR "Ryu" LEARN [
+    ABILITY_NAME(Quick_Jab)
+    ABILITY_NAME(Stun_Gun)
+]
+
+DEAR "Zangief" LEARN [
+    ABILITY_NAME(Power_Slam)
+    ABILITY_NAME(Meditate)
+]
+
+DEAR "Jack-6" LEARN [
+    ABILITY_NAME(Power_Slam)
+    ABILITY_NAME(Quick_Jab)
+]
+
+DEAR "Lee" LEARN [
+    ABILITY_NAME(Give_Autographs)
+    ABILITY_NAME(Quick_Jab)
+    ABILITY_NAME(Meditate)
+]
+
+TOURNAMENT(4, 20000)
+
+END_GAME
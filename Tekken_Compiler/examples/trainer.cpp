@@ -0,0 +1,71 @@
+#include "../include/TekkenTrainer.h"
+
+BEGIN_GAME
+
+CREATE ABILITY {
+    NAME: "Quick_Jab",
+    ACTION: START
+        DAMAGE DEFENDER 10
+    END
+}
+
+CREATE ABILITY {
+    NAME: "Power_Slam",
+    ACTION: START
+        DAMAGE DEFENDER 25
+    END
+}
+
+CREATE ABILITY {
+    NAME: "Meditate",
+    ACTION: START
+        HEAL ATTACKER 15
+    END
+}
+
+CREATE ABILITY {
+    NAME: "Bleeding_Bite",
+    ACTION: START
+        FOR 5 ROUNDS DO
+            DAMAGE DEFENDER 8
+        END
+    END
+}
+
+CREATE ABILITY {
+    NAME: "Iron_Guard",
+    ACTION: START
+        APPLY ATTACKER SHIELD 2
+    END
+}
+
+CREATE FIGHTER {
+    NAME: "Lee",
+    TYPE: "Rushdown",
+    HP: 100
+}
+
+CREATE FIGHTER {
+    NAME: "Jack-6",
+    TYPE: "Heavy",
+    HP: 90
+}
+
+DEAR "Lee" LEARN [
+    ABILITY_NAME(Quick_Jab)
+    ABILITY_NAME(Meditate)
+    ABILITY_NAME(Bleeding_Bite)
+]
+
+DEAR "Jack-6" LEARN [
+    ABILITY_NAME(Power_Slam)
+    ABILITY_NAME(Meditate)
+    ABILITY_NAME(Bleeding_Bite)
+    ABILITY_NAME(Iron_Guard)
+]
+
+TRAIN_POLICY(200000, "tekken_policy.txt")
+
+AI_DUEL("tekken_policy.txt")
+
+END_GAME
@@ -8,6 +8,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <initializer_list>
+#include <cstdint>
 
 enum class FighterType { Rushdown, Grappler, Heavy, Evasive };
 
@@ -29,13 +30,33 @@ inline std::string typeToStr(FighterType t) {
     return "";
 }
 
+// Durations count the affected fighter's own turns, whichever seat applied
+// the effect: N covers its next N turns, skipped ones included. Stun skips
+// those turns, Shield halves incoming damage, Buff adds 25% to outgoing
+// damage and Poison drains 5% of max HP at the end of each of them.
+enum class StatusEffect : uint8_t { Stun, Shield, Buff, Poison };
+static const int kStatusCount = 4;
+
+inline const char* statusToStr(StatusEffect s) {
+    switch(s) {
+        case StatusEffect::Stun: return "Stun";
+        case StatusEffect::Shield: return "Shield";
+        case StatusEffect::Buff: return "Buff";
+        case StatusEffect::Poison: return "Poison";
+    }
+    return "";
+}
+
 class Fighter {
     std::string name_; FighterType type_; int maxHP_, hp_; bool inRing_;
+    uint8_t status_;                       // one bit per StatusEffect
+    uint8_t statusFresh_;                  // bits applied during the current own turn
+    uint8_t statusTurns_[kStatusCount];    // own turns left for each set bit
     std::vector<std::string> abilities_;
 public:
-    Fighter() : type_(FighterType::Rushdown), maxHP_(100), hp_(100), inRing_(true) {}
+    Fighter() : type_(FighterType::Rushdown), maxHP_(100), hp_(100), inRing_(true), status_(0), statusFresh_(0), statusTurns_() {}
     Fighter(const std::string& n, const std::string& t, int h)
-        : name_(n), type_(strToType(t)), maxHP_(h), hp_(h), inRing_(true) {}
+        : name_(n), type_(strToType(t)), maxHP_(h), hp_(h), inRing_(true), status_(0), statusFresh_(0), statusTurns_() {}
     const std::string& getName() const { return name_; }
     std::string getTypeString() const { return typeToStr(type_); }
     FighterType getType() const { return type_; }
@@ -47,6 +68,32 @@ public:
     void setInRing(bool v) { inRing_ = v; }
     void addAbility(const std::string& a) { abilities_.push_back(a); }
     const std::vector<std::string>& getAbilities() const { return abilities_; }
+
+    bool hasStatus(StatusEffect s) const { return (status_ >> static_cast<int>(s)) & 1; }
+    int getStatusTurns(StatusEffect s) const { return hasStatus(s) ? statusTurns_[static_cast<int>(s)] : 0; }
+    uint8_t getStatusBits() const { return status_; }
+    // Sets the effect for the fighter's next `turns` own turns; zero or
+    // less removes it.
+    void applyStatus(StatusEffect s, int turns) {
+        int i = static_cast<int>(s);
+        if(turns <= 0) { status_ &= static_cast<uint8_t>(~(1u << i)); statusTurns_[i] = 0; return; }
+        status_ |= static_cast<uint8_t>(1u << i);
+        statusFresh_ |= static_cast<uint8_t>(1u << i);
+        statusTurns_[i] = static_cast<uint8_t>(turns > 255 ? 255 : turns);
+    }
+    // Called by the bound ActionContext around each of the fighter's own
+    // turns, taken or skipped. An effect applied during the turn starts
+    // counting from the next one.
+    void beginTurn() { statusFresh_ = 0; }
+    void endTurn() {
+        uint8_t due = status_ & static_cast<uint8_t>(~statusFresh_);
+        statusFresh_ = 0;
+        if(!due) return;
+        if((due >> static_cast<int>(StatusEffect::Poison)) & 1) takeDamage(maxHP_ >= 20 ? maxHP_ / 20 : 1);
+        for(int i = 0; i < kStatusCount; ++i) {
+            if(((due >> i) & 1) && --statusTurns_[i] == 0) status_ &= static_cast<uint8_t>(~(1u << i));
+        }
+    }
     
     double getOutgoingMod(const Fighter& target, int round) const {
         double mod = 1.0;
@@ -62,6 +109,7 @@ public:
                 break;
             default: break;
         }
+        if(hasStatus(StatusEffect::Buff)) mod *= 1.25;
         return mod;
     }
     
@@ -76,6 +124,7 @@ public:
                 break;
             default: break;
         }
+        if(hasStatus(StatusEffect::Shield)) mod *= 0.5;
         return mod;
     }
     
@@ -106,7 +155,14 @@ inline void regAbility(const std::string& n, AbilityAction a) {
 class ActionContext {
     std::vector<std::pair<int, std::function<void()>>> forActs_, afterActs_;
     int round_ = 0;
+    Fighter* owner_ = nullptr;
 public:
+    // processRound() runs once per round for both seats; beginTurn() and
+    // endTurn() bracket each of the bound fighter's own turns, which is what
+    // its status durations count.
+    void bind(Fighter& f) { owner_ = &f; }
+    void beginTurn() { if(owner_) owner_->beginTurn(); }
+    void endTurn() { if(owner_) owner_->endTurn(); }
     void scheduleFor(int r, std::function<void()> a) { 
         if(r>0) forActs_.push_back({r,std::move(a)}); 
     }
@@ -122,6 +178,7 @@ public:
         for(auto it=afterActs_.begin(); it!=afterActs_.end();)
             if(it->first==r){it->second();it=afterActs_.erase(it);} else ++it;
     }
+    size_t pending() const { return forActs_.size() + afterActs_.size(); }
     void clear() { forActs_.clear(); afterActs_.clear(); round_=0; }
 };
 
@@ -132,6 +189,14 @@ inline void printFighterStatus(const Fighter& f, bool wasOutOfRing, bool isNowOu
     std::cout << "Name: " << f.getName() << "\n";
     std::cout << "HP: " << f.getHP() << "\n";
     std::cout << "Type: " << f.getTypeString() << "\n";
+    if (f.getStatusBits()) {
+        std::cout << "Status:";
+        for (int i = 0; i < kStatusCount; ++i) {
+            StatusEffect s = static_cast<StatusEffect>(i);
+            if (f.hasStatus(s)) std::cout << " " << statusToStr(s) << "(" << f.getStatusTurns(s) << ")";
+        }
+        std::cout << "\n";
+    }
     if (isNowOutOfRing && !wasOutOfRing) {
         std::cout << "fighter exits the ring\n";
     } else if (!isNowOutOfRing && wasOutOfRing) {
@@ -144,16 +209,201 @@ inline void printFighterStatus(const Fighter& f, bool wasOutOfRing, bool isNowOu
     std::cout << "##########################\n";
 }
 
-inline void runDuel() {
-    auto& fighters = g_fighters();
-    auto& abilities = g_abilities();
-    
+// Deterministic splitmix64 stream used by the headless duel path.
+struct DuelRng {
+    uint64_t state;
+    explicit DuelRng(uint64_t seed) : state(seed) {}
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    int below(int n) { return n > 0 ? static_cast<int>(next() % static_cast<uint64_t>(n)) : 0; }
+};
+
+inline uint64_t mixSeed(uint64_t a, uint64_t b) {
+    DuelRng r(a ^ (b * 0xD1B54A32D192ED03ULL));
+    return r.next();
+}
+
+// Picks an index into self.getAbilities(), or -1 to pass the turn.
+using DuelController = std::function<int(const Fighter& self, const Fighter& foe, int round,
+                                         const ActionContext& ctx, DuelRng& rng)>;
+
+inline int randomController(const Fighter& self, const Fighter&, int, const ActionContext&, DuelRng& rng) {
+    int n = static_cast<int>(self.getAbilities().size());
+    return n > 0 ? rng.below(n) : -1;
+}
+
+// When set, runDuel() asks this controller for Player2's moves instead of stdin.
+inline DuelController& g_player2Controller() {
+    static DuelController c; return c;
+}
+
+inline std::vector<std::string> rosterNames() {
     std::vector<std::string> names;
-    for(auto& p : fighters) {
+    for(auto& p : g_fighters()) {
         if(p.first != "_DUMMY_" && p.first != "_END_") names.push_back(p.first);
     }
+    return names;
+}
+
+inline void castRegistered(const std::string& name, Fighter& attacker, Fighter& defender, int round, ActionContext& ctx) {
+    auto it = g_abilities().find(name);
+    if(it != g_abilities().end()) it->second.action(attacker, defender, round, ctx);
+}
+
+using AbilityCaster = std::function<void(const std::string&, Fighter&, Fighter&, int, ActionContext&)>;
+
+// Where runDuel() finds fighters and abilities. The default reads the
+// g_fighters()/g_abilities() registries; TekkenRoster.h swaps in a mapped
+// roster image so only the two selected fighters are ever materialised.
+struct DuelSource {
+    std::function<size_t()> count;
+    std::function<void(std::ostream&)> list;
+    std::function<bool(const std::string&, Fighter&)> find;
+    AbilityCaster cast;
+};
+
+inline DuelSource registryDuelSource() {
+    DuelSource s;
+    s.count = [] { return rosterNames().size(); };
+    s.list = [](std::ostream& os) { for(const auto& n : rosterNames()) os << n << "\n"; };
+    s.find = [](const std::string& n, Fighter& out) {
+        auto it = g_fighters().find(n);
+        if(it == g_fighters().end()) return false;
+        out = it->second;
+        return true;
+    };
+    s.cast = castRegistered;
+    return s;
+}
+
+inline DuelSource& g_duelSource() {
+    static DuelSource s = registryDuelSource(); return s;
+}
+
+struct DuelOutcome {
+    int winner;   // 1 or 2, 0 for a draw
+    int rounds;
+    int hp1, hp2;
+};
+
+// Narration hooks for playDuel(); seats are 1 and 2. Headless callers pass none.
+struct DuelObserver {
+    std::function<void(int round)> roundStarted;
+    std::function<void(int seat, const Fighter& self)> turnSkipped;
+    std::function<void(int seat, const Fighter& self, const Fighter& foe)> turnPlayed;
+    std::function<void(const DuelOutcome&, const Fighter& f1, const Fighter& f2)> finished;
+};
+
+// The duel rules, shared by the console DUEL and every headless mode: up to
+// 100 rounds, each starting with the Grappler bonus and scheduled FOR/AFTER
+// effects, then Player1's turn and Player2's turn. A fighter out of the ring
+// or stunned skips its turn; otherwise its controller picks the ability.
+inline DuelOutcome playDuel(Fighter& f1, Fighter& f2, const DuelController& c1, const DuelController& c2,
+                            const AbilityCaster& cast, DuelRng& rng, const DuelObserver* obs = nullptr) {
+    ActionContext ctx1, ctx2;
+    ctx1.bind(f1);
+    ctx2.bind(f2);
+    Fighter* fighters[2] = {&f1, &f2};
+    ActionContext* contexts[2] = {&ctx1, &ctx2};
+    const DuelController* controllers[2] = {&c1, &c2};
+    auto finish = [&](int winner, int round) {
+        DuelOutcome o{winner, round, f1.getHP(), f2.getHP()};
+        if(obs && obs->finished) obs->finished(o, f1, f2);
+        return o;
+    };
+
+    for(int round = 1; round <= 100; ++round) {
+        if(obs && obs->roundStarted) obs->roundStarted(round);
+        f1.applyGrapplerBonus(round);
+        f2.applyGrapplerBonus(round);
+        ctx1.processRound(round);
+        ctx2.processRound(round);
+
+        if(f1.getHP() <= 0) return finish(2, round);
+        if(f2.getHP() <= 0) return finish(1, round);
+
+        for(int seat = 0; seat < 2; ++seat) {
+            Fighter& self = *fighters[seat];
+            Fighter& foe = *fighters[1 - seat];
+            ActionContext& ctx = *contexts[seat];
+            ctx.beginTurn();
+            if(self.isOutOfRing() || self.hasStatus(StatusEffect::Stun)) {
+                if(obs && obs->turnSkipped) obs->turnSkipped(seat + 1, self);
+            } else {
+                const DuelController& c = *controllers[seat];
+                int pick = c ? c(self, foe, round, ctx, rng) : -1;
+                const auto& abs = self.getAbilities();
+                if(pick >= 0 && pick < static_cast<int>(abs.size())) cast(abs[pick], self, foe, round, ctx);
+                if(obs && obs->turnPlayed) obs->turnPlayed(seat + 1, self, foe);
+            }
+            if(foe.getHP() <= 0) return finish(seat == 0 ? 1 : 2, round);
+            ctx.endTurn();
+            if(self.getHP() <= 0) return finish(seat == 0 ? 2 : 1, round);
+        }
+    }
+    return finish(0, 100);
+}
+
+// Lists the fighter's abilities and reads the choice from stdin, or shows
+// the pick of `ai` when one is given. -1 for an ability it has not learned.
+inline DuelController consoleController(int seat, DuelController ai = nullptr) {
+    return [seat, ai](const Fighter& self, const Fighter& foe, int round, const ActionContext& ctx, DuelRng& rng) {
+        std::cout << "\n" << self.getName() << "(Player" << seat << ") select ability:\n";
+        std::cout << "------------------------\n";
+        const auto& abs = self.getAbilities();
+        for(size_t i = 0; i < abs.size(); ++i) {
+            std::cout << abs[i] << "\n";
+        }
+        std::cout << "------------------------\n";
+
+        std::string abilityName;
+        if(ai) {
+            int pick = ai(self, foe, round, ctx, rng);
+            if(pick >= 0 && pick < static_cast<int>(abs.size())) abilityName = abs[pick];
+            std::cout << abilityName << "\n";
+        } else {
+            std::getline(std::cin >> std::ws, abilityName);
+        }
+        for(size_t i = 0; i < abs.size(); ++i) {
+            if(abs[i] == abilityName) return static_cast<int>(i);
+        }
+        return -1;
+    };
+}
+
+inline DuelObserver consoleObserver() {
+    DuelObserver obs;
+    obs.roundStarted = [](int round) {
+        std::cout << "\n~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n";
+        std::cout << "Round " << round << "\n";
+        std::cout << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n\n";
+    };
+    obs.turnSkipped = [](int seat, const Fighter& self) {
+        if(self.isOutOfRing()) {
+            std::cout << "\n" << self.getName() << "(Player" << seat << ") has not a fighter that can enter the ring so he can't cast an ability.\n";
+        } else {
+            std::cout << "\n" << self.getName() << "(Player" << seat << ") is stunned so he can't cast an ability.\n";
+        }
+    };
+    obs.turnPlayed = [](int, const Fighter& self, const Fighter& foe) {
+        printFighterStatus(foe, false, foe.isOutOfRing());
+        printFighterStatus(self, false, self.isOutOfRing());
+    };
+    obs.finished = [](const DuelOutcome& o, const Fighter& f1, const Fighter& f2) {
+        if(o.winner == 0) std::cout << "Draw!\n";
+        else std::cout << "\n" << (o.winner == 1 ? f1 : f2).getName() << " WINS!\n";
+    };
+    return obs;
+}
+
+inline void runDuel() {
+    const DuelSource& source = g_duelSource();
     
-    if(names.empty()) {
+    if(source.count() == 0) {
         std::cout << "No fighters available!\n";
         return;
     }
@@ -162,9 +412,7 @@ inline void runDuel() {
     
     std::cout << "Player1 select fighter:\n";
     std::cout << "------------------------\n";
-    for(size_t i = 0; i < names.size(); ++i) {
-        std::cout << names[i] << "\n";
-    }
+    source.list(std::cout);
     std::cout << "------------------------\n";
     
     std::string p1Name;
@@ -172,93 +420,31 @@ inline void runDuel() {
     
     std::cout << "\nPlayer2 select fighter:\n";
     std::cout << "------------------------\n";
-    for(size_t i = 0; i < names.size(); ++i) {
-        std::cout << names[i] << "\n";
-    }
+    source.list(std::cout);
     std::cout << "------------------------\n";
     
     std::string p2Name;
     std::getline(std::cin >> std::ws, p2Name);
     
-    if(fighters.find(p1Name) == fighters.end() || fighters.find(p2Name) == fighters.end()) {
+    Fighter f1, f2;
+    if(!source.find(p1Name, f1) || !source.find(p2Name, f2)) {
         std::cout << "Invalid fighter selection!\n";
         return;
     }
     
-    Fighter f1 = fighters[p1Name];
-    Fighter f2 = fighters[p2Name];
-    
-    ActionContext ctx1, ctx2;
-    int round = 1;
-    
-    while(true) {
-        std::cout << "\n~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n";
-        std::cout << "Round " << round << "\n";
-        std::cout << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n\n";
-        
-        f1.applyGrapplerBonus(round);
-        f2.applyGrapplerBonus(round);
-        ctx1.processRound(round);
-        ctx2.processRound(round);
-        
-        if(f1.getHP() <= 0) { std::cout << "\n" << f2.getName() << " WINS!\n"; break; }
-        if(f2.getHP() <= 0) { std::cout << "\n" << f1.getName() << " WINS!\n"; break; }
-        
-        if(f1.isOutOfRing()) {
-            std::cout << "\n" << f1.getName() << "(Player1) has not a fighter that can enter the ring so he can't cast an ability.\n";
-        } else {
-            std::cout << "\n" << f1.getName() << "(Player1) select ability:\n";
-            std::cout << "------------------------\n";
-            auto& abs1 = f1.getAbilities();
-            for(size_t i = 0; i < abs1.size(); ++i) {
-                std::cout << abs1[i] << "\n";
-            }
-            std::cout << "------------------------\n";
-            
-            std::string abilityName;
-            std::getline(std::cin >> std::ws, abilityName);
-            
-            bool hasAbility = false;
-            for(const auto& a : abs1) { if(a == abilityName) hasAbility = true; }
-            if(hasAbility && abilities.count(abilityName)) {
-                abilities[abilityName].action(f1, f2, round, ctx1);
-            }
-            
-            printFighterStatus(f2, false, f2.isOutOfRing());
-            printFighterStatus(f1, false, f1.isOutOfRing());
-        }
-        
-        if(f2.getHP() <= 0) { std::cout << "\n" << f1.getName() << " WINS!\n"; break; }
-        
-        if(f2.isOutOfRing()) {
-            std::cout << "\n" << f2.getName() << "(Player2) has not a fighter that can enter the ring so he can't cast an ability.\n";
-        } else {
-            std::cout << "\n" << f2.getName() << "(Player2) select ability:\n";
-            std::cout << "------------------------\n";
-            auto& abs2 = f2.getAbilities();
-            for(size_t i = 0; i < abs2.size(); ++i) {
-                std::cout << abs2[i] << "\n";
-            }
-            std::cout << "------------------------\n";
-            
-            std::string abilityName;
-            std::getline(std::cin >> std::ws, abilityName);
-            
-            bool hasAbility = false;
-            for(const auto& a : abs2) { if(a == abilityName) hasAbility = true; }
-            if(hasAbility && abilities.count(abilityName)) {
-                abilities[abilityName].action(f2, f1, round, ctx2);
-            }
-            
-            printFighterStatus(f1, false, f1.isOutOfRing());
-            printFighterStatus(f2, false, f2.isOutOfRing());
-        }
-        
-        if(f1.getHP() <= 0) { std::cout << "\n" << f2.getName() << " WINS!\n"; break; }
-        
-        round++;
-        if(round > 100) { std::cout << "Draw!\n"; break; }
-    }
+    DuelObserver obs = consoleObserver();
+    DuelRng aiRng(1);
+    playDuel(f1, f2, consoleController(1), consoleController(2, g_player2Controller()), source.cast, aiRng, &obs);
+}
+
+// runDuel() without console I/O, so it can run many duels in parallel. Only
+// reads g_abilities(); fighters are copied.
+inline DuelOutcome simulateDuel(const Fighter& p1, const Fighter& p2,
+                                const DuelController& c1, const DuelController& c2,
+                                uint64_t seed) {
+    Fighter f1 = p1, f2 = p2;
+    DuelRng rng(seed);
+    return playDuel(f1, f2, c1, c2, castRegistered, rng);
 }
 
 struct _FInit_ {
@@ -506,6 +692,43 @@ struct _TagCmd_ {
 #define TAG ; _TagCmd_{} <<
 #define SHOW ; std::cout <<
 
+struct _StatusTag_ { StatusEffect s; };
+
+struct _ApplyFinal_ {
+    Fighter& target;
+    StatusEffect s;
+    
+    _ApplyFinal_(Fighter& t, StatusEffect st) : target(t), s(st) {}
+    
+    void operator<<(int turns) const {
+        target.applyStatus(s, turns);
+    }
+};
+
+struct _ApplyTarget_ {
+    Fighter& target;
+    
+    _ApplyTarget_(Fighter& t) : target(t) {}
+    
+    _ApplyFinal_ operator<<(_StatusTag_ tag) const {
+        return _ApplyFinal_(target, tag.s);
+    }
+};
+
+struct _ApplyCmd_ {
+    _ApplyCmd_() {}
+    
+    _ApplyTarget_ operator<<(Fighter& target) const {
+        return _ApplyTarget_(target);
+    }
+};
+
+#define APPLY ; _ApplyCmd_{} <<
+#define STUN _StatusTag_{StatusEffect::Stun} <<
+#define SHIELD _StatusTag_{StatusEffect::Shield} <<
+#define BUFF _StatusTag_{StatusEffect::Buff} <<
+#define POISON _StatusTag_{StatusEffect::Poison} <<
+
 struct _GetEnd_ {};
 static _GetEnd_ _get_end_;
 
@@ -540,10 +763,20 @@ struct _IsOutOfRingProxy_ {
     bool operator<<(_GetEnd_) const { return f ? f->isOutOfRing() : false; }
 };
 
+struct _HasStatusProxy_ {
+    Fighter* f;
+    StatusEffect s;
+    _HasStatusProxy_() : f(nullptr), s(StatusEffect::Stun) {}
+    _HasStatusProxy_& operator<<(Fighter& fighter) { f = &fighter; return *this; }
+    _HasStatusProxy_& operator<<(_StatusTag_ tag) { s = tag.s; return *this; }
+    bool operator<<(_GetEnd_) const { return f ? f->hasStatus(s) : false; }
+};
+
 #define GET_HP(x) (_GetHPProxy_{} << x _get_end_)
 #define GET_TYPE(x) (_GetTypeProxy_{} << x _get_end_)
 #define GET_NAME(x) (_GetNameProxy_{} << x _get_end_)
 #define IS_OUT_OF_RING(x) (_IsOutOfRingProxy_{} << x _get_end_)
+#define HAS_STATUS(x, s) (_HasStatusProxy_{} << x s _get_end_)
 
 #define AND(...) ([&]{ bool _args_[] = {__VA_ARGS__}; for(bool _b_ : _args_) if(!_b_) return false; return true; }())
 #define OR(...) ([&]{ bool _args_[] = {__VA_ARGS__}; for(bool _b_ : _args_) if(_b_) return true; return false; }())
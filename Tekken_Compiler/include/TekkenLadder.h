@@ -0,0 +1,239 @@
+#ifndef TEKKEN_LADDER_H
+#define TEKKEN_LADDER_H
+
+#include "Tekken.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <iomanip>
+#include <thread>
+
+// Glicko-1 rating state, kept in one contiguous array indexed by fighter id.
+struct LadderEntry {
+    float rating;
+    float rd;
+    uint32_t games;
+    uint32_t wins;
+};
+
+struct LadderReport {
+    int rounds = 0;
+    uint64_t matches = 0;
+    double seconds = 0.0;
+    double matchesPerSecond = 0.0;
+    double bytesPerFighter = 0.0;
+};
+
+class Ladder {
+    static constexpr float kBucketWidth = 25.0f;
+    static constexpr int kBuckets = 160;           // covers ratings 0..4000
+    static constexpr float kRdFloor = 30.0f;
+    static constexpr float kRdCeil = 350.0f;
+    static constexpr float kRdDrift = 15.0f;       // RD growth per ladder round
+
+    std::vector<Fighter> fighters_;
+    std::vector<LadderEntry> ratings_;
+    std::vector<uint32_t> order_;                  // fighter ids grouped by rating bucket
+    std::vector<uint32_t> bucketStart_;
+    std::vector<std::pair<uint32_t, uint32_t>> pairs_;
+    std::vector<DuelOutcome> outcomes_;
+    DuelController controller_;
+    uint64_t seed_;
+    unsigned threads_;
+    int round_ = 0;
+    LadderReport report_;
+
+    static int bucketOf(float rating) {
+        int b = static_cast<int>(rating / kBucketWidth);
+        return b < 0 ? 0 : (b >= kBuckets ? kBuckets - 1 : b);
+    }
+
+    // Counting sort by bucket, then shuffle inside each bucket and pair
+    // neighbours. Every pick is O(1); a leftover spills into the next bucket.
+    void buildPairs(DuelRng& rng) {
+        size_t n = ratings_.size();
+        bucketStart_.assign(kBuckets + 1, 0);
+        for(size_t i = 0; i < n; ++i) bucketStart_[bucketOf(ratings_[i].rating) + 1]++;
+        for(int b = 0; b < kBuckets; ++b) bucketStart_[b + 1] += bucketStart_[b];
+        std::vector<uint32_t> fill(bucketStart_.begin(), bucketStart_.end() - 1);
+        order_.resize(n);
+        for(size_t i = 0; i < n; ++i) order_[fill[bucketOf(ratings_[i].rating)]++] = static_cast<uint32_t>(i);
+
+        for(int b = 0; b < kBuckets; ++b) {
+            for(uint32_t i = bucketStart_[b + 1]; i > bucketStart_[b] + 1; --i) {
+                uint32_t j = bucketStart_[b] + static_cast<uint32_t>(rng.next() % (i - bucketStart_[b]));
+                std::swap(order_[i - 1], order_[j]);
+            }
+        }
+
+        pairs_.clear();
+        for(size_t i = 0; i + 1 < n; i += 2) pairs_.push_back({order_[i], order_[i + 1]});
+    }
+
+    void playPairs() {
+        outcomes_.resize(pairs_.size());
+        std::atomic<size_t> next(0);
+        const size_t chunk = 64;
+        uint64_t roundSeed = mixSeed(seed_, static_cast<uint64_t>(round_));
+        auto work = [&]() {
+            for(;;) {
+                size_t begin = next.fetch_add(chunk);
+                if(begin >= pairs_.size()) return;
+                size_t stop = std::min(begin + chunk, pairs_.size());
+                for(size_t m = begin; m < stop; ++m) {
+                    outcomes_[m] = simulateDuel(fighters_[pairs_[m].first], fighters_[pairs_[m].second],
+                                                controller_, controller_, mixSeed(roundSeed, m));
+                }
+            }
+        };
+        unsigned n = std::max(1u, std::min<unsigned>(threads_, static_cast<unsigned>(pairs_.size() / chunk + 1)));
+        std::vector<std::thread> pool;
+        for(unsigned t = 1; t < n; ++t) pool.emplace_back(work);
+        work();
+        for(auto& t : pool) t.join();
+    }
+
+    // Each fighter plays at most once per round, so one Glicko-1 rating
+    // period per round; results are applied in match order after the round.
+    void applyRatings() {
+        const double q = std::log(10.0) / 400.0;
+        const double pi2 = 3.14159265358979323846 * 3.14159265358979323846;
+        auto g = [&](double rd) { return 1.0 / std::sqrt(1.0 + 3.0 * q * q * rd * rd / pi2); };
+
+        for(auto& e : ratings_) {
+            float rd = std::sqrt(e.rd * e.rd + kRdDrift * kRdDrift);
+            e.rd = rd < kRdCeil ? rd : kRdCeil;
+        }
+
+        for(size_t m = 0; m < pairs_.size(); ++m) {
+            LadderEntry& a = ratings_[pairs_[m].first];
+            LadderEntry& b = ratings_[pairs_[m].second];
+            double sa = outcomes_[m].winner == 1 ? 1.0 : (outcomes_[m].winner == 2 ? 0.0 : 0.5);
+            LadderEntry oa = a, ob = b;
+            auto update = [&](LadderEntry& self, const LadderEntry& me, const LadderEntry& foe, double s) {
+                double gf = g(foe.rd);
+                double ex = 1.0 / (1.0 + std::pow(10.0, -gf * (me.rating - foe.rating) / 400.0));
+                double d2 = 1.0 / (q * q * gf * gf * ex * (1.0 - ex));
+                double denom = 1.0 / (me.rd * me.rd) + 1.0 / d2;
+                self.rating = static_cast<float>(me.rating + q / denom * gf * (s - ex));
+                float rd = static_cast<float>(std::sqrt(1.0 / denom));
+                self.rd = rd > kRdFloor ? rd : kRdFloor;
+                self.games++;
+                if(s == 1.0) self.wins++;
+            };
+            update(a, oa, ob, sa);
+            update(b, ob, oa, 1.0 - sa);
+        }
+    }
+
+public:
+    explicit Ladder(uint64_t seed = 1, unsigned threads = std::thread::hardware_concurrency())
+        : controller_(randomController), seed_(seed), threads_(threads ? threads : 1) {}
+
+    void addFighter(const Fighter& f) {
+        fighters_.push_back(f);
+        ratings_.push_back({1500.0f, kRdCeil, 0, 0});
+    }
+    void setController(DuelController c) { controller_ = std::move(c); }
+
+    size_t size() const { return fighters_.size(); }
+    const Fighter& fighter(size_t i) const { return fighters_[i]; }
+    const LadderEntry& entry(size_t i) const { return ratings_[i]; }
+    const LadderReport& report() const { return report_; }
+
+    void playRound() {
+        DuelRng rng(mixSeed(seed_ ^ 0xA5A5A5A5ULL, static_cast<uint64_t>(round_)));
+        auto t0 = std::chrono::steady_clock::now();
+        buildPairs(rng);
+        playPairs();
+        applyRatings();
+        auto t1 = std::chrono::steady_clock::now();
+        round_++;
+        report_.rounds = round_;
+        report_.matches += pairs_.size();
+        report_.seconds += std::chrono::duration<double>(t1 - t0).count();
+        report_.matchesPerSecond = report_.seconds > 0 ? report_.matches / report_.seconds : 0.0;
+        report_.bytesPerFighter = bytesPerFighter();
+    }
+
+    void play(int rounds) { for(int r = 0; r < rounds; ++r) playRound(); }
+
+    // Ratings, bucket index and fighter storage (including heap-held names
+    // and learn-sets), averaged over the population.
+    double bytesPerFighter() const {
+        if(fighters_.empty()) return 0.0;
+        size_t bytes = ratings_.capacity() * sizeof(LadderEntry)
+                     + order_.capacity() * sizeof(uint32_t)
+                     + bucketStart_.capacity() * sizeof(uint32_t)
+                     + pairs_.capacity() * sizeof(pairs_[0])
+                     + outcomes_.capacity() * sizeof(DuelOutcome)
+                     + fighters_.capacity() * sizeof(Fighter);
+        // Strings longer than the inline (small-string) buffer own a heap block.
+        const size_t inlineCap = std::string().capacity();
+        for(const auto& f : fighters_) {
+            if(f.getName().capacity() > inlineCap) bytes += f.getName().capacity() + 1;
+            bytes += f.getAbilities().capacity() * sizeof(std::string);
+            for(const auto& a : f.getAbilities()) {
+                if(a.capacity() > inlineCap) bytes += a.capacity() + 1;
+            }
+        }
+        return static_cast<double>(bytes) / fighters_.size();
+    }
+
+    std::vector<size_t> standings() const {
+        std::vector<size_t> ids(ratings_.size());
+        for(size_t i = 0; i < ids.size(); ++i) ids[i] = i;
+        std::stable_sort(ids.begin(), ids.end(), [&](size_t a, size_t b) {
+            return ratings_[a].rating > ratings_[b].rating;
+        });
+        return ids;
+    }
+};
+
+inline void printLadder(const Ladder& ladder, size_t top) {
+    auto ids = ladder.standings();
+    std::cout << "\n----------------------------------LADDER-----------------------------------\n";
+    for(size_t i = 0; i < ids.size() && i < top; ++i) {
+        const LadderEntry& e = ladder.entry(ids[i]);
+        std::cout << std::setw(4) << (i + 1) << ". " << std::left << std::setw(24) << ladder.fighter(ids[i]).getName()
+                  << std::right << std::fixed << std::setprecision(1)
+                  << " rating " << std::setw(7) << e.rating << " rd " << std::setw(5) << e.rd
+                  << "  " << e.wins << "/" << e.games << "\n";
+    }
+    const LadderReport& r = ladder.report();
+    std::cout << "---------------------------------------------------------------------------\n";
+    std::cout << "Fighters: " << ladder.size() << "  Rounds: " << r.rounds << "  Matches: " << r.matches << "\n";
+    std::cout << std::setprecision(0) << "Throughput: " << r.matchesPerSecond << " matches/s"
+              << std::setprecision(1) << "  Memory: " << r.bytesPerFighter << " bytes/fighter\n";
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+// Fills a ladder with `population` fighters cloned round-robin from the
+// registered roster, each with up to +/-20% HP variation.
+inline void runLadder(size_t population, int rounds) {
+    std::vector<std::string> names = rosterNames();
+    if(names.empty()) {
+        std::cout << "No fighters available!\n";
+        return;
+    }
+    if(population < names.size()) population = names.size();
+
+    Ladder ladder;
+    DuelRng rng(0x7E4CE11ULL);
+    for(size_t i = 0; i < population; ++i) {
+        const Fighter& proto = getFighter(names[i % names.size()]);
+        int hp = proto.getMaxHP();
+        if(i >= names.size()) hp += static_cast<int>((static_cast<int>(rng.below(41)) - 20) * hp / 100);
+        Fighter f(proto.getName() + "#" + std::to_string(i / names.size()), proto.getTypeString(), hp > 1 ? hp : 1);
+        for(const auto& a : proto.getAbilities()) f.addAbility(a);
+        ladder.addFighter(f);
+    }
+    ladder.play(rounds);
+    printLadder(ladder, 10);
+}
+
+#define LADDER(population, rounds) ,false)){} runLadder(population, rounds); if(false){}else if((_FInit_{"_END_","Rushdown",1}
+
+#endif
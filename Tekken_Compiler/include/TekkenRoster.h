@@ -0,0 +1,616 @@
+#ifndef TEKKEN_ROSTER_H
+#define TEKKEN_ROSTER_H
+
+#include "Tekken.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Roster definition files describe the same things as the CREATE / DEAR
+// macros, one statement per line ('#' starts a comment):
+//
+//   ability Combo_Strike
+//       if hp defender > 50
+//           damage defender 20
+//       else
+//           damage defender 35
+//       end
+//       for 3
+//           heal attacker 5
+//       end
+//   end
+//   fighter Ryu Rushdown 100
+//   learn Ryu Combo_Strike
+//
+// Statements inside an ability: damage/heal <who> <n>, tag <who> in|out,
+// apply <who> <status> <n>, for <n> ... end, after <n> ... end,
+// if [not] <cond> ... [else ...] end.
+// Conditions: hp <who> <op> <n>, out <who>, type <who> <Type>,
+// status <who> <status>. Statuses: stun, shield, buff, poison.
+//
+// compileRoster() turns that text into a flat image whose records refer to
+// each other by offsets from the image start, so RosterImage can mmap the
+// file and use it in place without parsing it or allocating per entry.
+// LOAD_ROSTER(path) followed by DUEL plays straight from the image;
+// INSTALL_ROSTER(path) copies it into the registries for LADDER, TOURNAMENT,
+// STATS and TRAIN_POLICY.
+
+enum class RosterOp : int32_t { Damage = 1, Heal, Tag, JumpUnless, Jump, Repeat, Delay, Apply };
+enum class RosterCond : int32_t { Hp = 1, Out, Type, Status };
+enum class RosterCmp : int32_t { Lt = 1, Le, Gt, Ge, Eq, Ne };
+
+struct RosterHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t fighterCount;
+    uint32_t abilityCount;
+    uint32_t fightersOff;    // RosterFighterRec[fighterCount], sorted by name
+    uint32_t abilitiesOff;   // RosterAbilityRec[abilityCount], sorted by name
+    uint32_t learnOff;       // uint32_t ability indices
+    uint32_t codeOff;        // int32_t words
+    uint32_t codeWords;
+    uint32_t stringsOff;
+    uint32_t totalSize;
+};
+
+struct RosterFighterRec {
+    uint32_t nameOff, nameLen;
+    uint32_t type;
+    int32_t hp;
+    uint32_t learnFirst, learnCount;
+};
+
+struct RosterAbilityRec {
+    uint32_t nameOff, nameLen;
+    uint32_t codeFirst, codeLen;
+};
+
+static const char kRosterMagic[8] = {'T', 'K', 'R', 'O', 'S', 'T', 'E', 'R'};
+static const uint32_t kRosterVersion = 2;
+
+struct RosterStr {
+    const char* data;
+    uint32_t size;
+    std::string str() const { return std::string(data, size); }
+    int compare(const char* s, size_t n) const {
+        int c = std::memcmp(data, s, size < n ? size : n);
+        return c ? c : (size < n ? -1 : (size > n ? 1 : 0));
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Interpreter for compiled ability bodies. Jump targets and block ends are
+// word indices relative to the ability's first word.
+
+inline bool rosterCheck(const int32_t* w, Fighter& attacker, Fighter& defender) {
+    Fighter& f = w[1] ? defender : attacker;
+    bool r = false;
+    switch(static_cast<RosterCond>(w[0])) {
+        case RosterCond::Hp:
+            switch(static_cast<RosterCmp>(w[2])) {
+                case RosterCmp::Lt: r = f.getHP() <  w[3]; break;
+                case RosterCmp::Le: r = f.getHP() <= w[3]; break;
+                case RosterCmp::Gt: r = f.getHP() >  w[3]; break;
+                case RosterCmp::Ge: r = f.getHP() >= w[3]; break;
+                case RosterCmp::Eq: r = f.getHP() == w[3]; break;
+                case RosterCmp::Ne: r = f.getHP() != w[3]; break;
+            }
+            break;
+        case RosterCond::Out: r = f.isOutOfRing(); break;
+        case RosterCond::Type: r = static_cast<int32_t>(f.getType()) == w[3]; break;
+        case RosterCond::Status: r = f.hasStatus(static_cast<StatusEffect>(w[3])); break;
+    }
+    return w[4] ? !r : r;
+}
+
+inline void runRosterCode(const int32_t* code, uint32_t pc, uint32_t stop,
+                          Fighter& attacker, Fighter& defender, int round, ActionContext& ctx) {
+    while(pc < stop) {
+        const int32_t* w = code + pc;
+        switch(static_cast<RosterOp>(w[0])) {
+            case RosterOp::Damage: {
+                Fighter& t = w[1] ? defender : attacker;
+                _DmgCmd_{attacker, round} << t << w[2];
+                pc += 3;
+                break;
+            }
+            case RosterOp::Heal:
+                (w[1] ? defender : attacker).heal(w[2]);
+                pc += 3;
+                break;
+            case RosterOp::Tag:
+                (w[1] ? defender : attacker).setInRing(w[2] != 0);
+                pc += 3;
+                break;
+            case RosterOp::Apply:
+                (w[1] ? defender : attacker).applyStatus(static_cast<StatusEffect>(w[2]), w[3]);
+                pc += 4;
+                break;
+            case RosterOp::JumpUnless:
+                pc = rosterCheck(w + 1, attacker, defender) ? pc + 7 : static_cast<uint32_t>(w[6]);
+                break;
+            case RosterOp::Jump:
+                pc = static_cast<uint32_t>(w[1]);
+                break;
+            case RosterOp::Repeat:
+            case RosterOp::Delay: {
+                Fighter* a = &attacker;
+                Fighter* d = &defender;
+                uint32_t first = pc + 3, last = static_cast<uint32_t>(w[2]);
+                auto body = [=]() {
+                    ActionContext dummyCtx;
+                    runRosterCode(code, first, last, *a, *d, 0, dummyCtx);
+                };
+                if(static_cast<RosterOp>(w[0]) == RosterOp::Repeat) ctx.scheduleFor(w[1], body);
+                else ctx.scheduleAfter(w[1], body);
+                pc = last;
+                break;
+            }
+            default:
+                return;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Read-only view over a compiled roster image.
+
+class RosterImage {
+    const char* base_ = nullptr;
+    size_t size_ = 0;
+    std::vector<char> owned_;
+#ifndef _WIN32
+    void* map_ = nullptr;
+#endif
+
+    const RosterHeader& header() const { return *reinterpret_cast<const RosterHeader*>(base_); }
+    template<typename T> const T* at(uint32_t off) const { return reinterpret_cast<const T*>(base_ + off); }
+
+    static void corrupt(const std::string& what) { throw std::runtime_error("Corrupt roster image: " + what); }
+
+    // Checks one ability body: every instruction is complete and well-formed,
+    // and every jump or block end lands forward on an instruction boundary.
+    void validateCode(const int32_t* code, uint32_t len, std::vector<char>& starts) const {
+        starts.assign(len + 1, 0);
+        auto who = [](int32_t w) { return w == 0 || w == 1; };
+        uint32_t pc = 0;
+        while(pc < len) {
+            starts[pc] = 1;
+            const int32_t* w = code + pc;
+            uint32_t width = 0;
+            bool ok = false;
+            switch(static_cast<RosterOp>(w[0])) {
+                case RosterOp::Damage: case RosterOp::Heal: case RosterOp::Tag:
+                    width = 3; ok = pc + width <= len && who(w[1]); break;
+                case RosterOp::Apply:
+                    width = 4; ok = pc + width <= len && who(w[1]) && w[2] >= 0 && w[2] < kStatusCount; break;
+                case RosterOp::JumpUnless:
+                    width = 7;
+                    if(pc + width > len || !who(w[2])) break;
+                    switch(static_cast<RosterCond>(w[1])) {
+                        case RosterCond::Hp: ok = w[3] >= static_cast<int32_t>(RosterCmp::Lt) && w[3] <= static_cast<int32_t>(RosterCmp::Ne); break;
+                        case RosterCond::Out: ok = true; break;
+                        case RosterCond::Type: ok = w[4] >= 0 && w[4] <= static_cast<int32_t>(FighterType::Evasive); break;
+                        case RosterCond::Status: ok = w[4] >= 0 && w[4] < kStatusCount; break;
+                    }
+                    break;
+                case RosterOp::Jump: width = 2; ok = pc + width <= len; break;
+                case RosterOp::Repeat: case RosterOp::Delay: width = 3; ok = pc + width <= len; break;
+            }
+            if(!ok) corrupt("bad instruction");
+            pc += width;
+        }
+        starts[len] = 1;
+        for(pc = 0; pc < len;) {
+            const int32_t* w = code + pc;
+            switch(static_cast<RosterOp>(w[0])) {
+                case RosterOp::JumpUnless:
+                    if(w[6] <= static_cast<int32_t>(pc) || static_cast<uint32_t>(w[6]) > len || !starts[w[6]]) corrupt("bad jump");
+                    pc += 7; break;
+                case RosterOp::Jump:
+                    if(w[1] <= static_cast<int32_t>(pc) || static_cast<uint32_t>(w[1]) > len || !starts[w[1]]) corrupt("bad jump");
+                    pc += 2; break;
+                case RosterOp::Repeat: case RosterOp::Delay:
+                    if(w[2] < static_cast<int32_t>(pc + 3) || static_cast<uint32_t>(w[2]) > len || !starts[w[2]]) corrupt("bad block");
+                    pc += 3; break;
+                case RosterOp::Apply: pc += 4; break;
+                default: pc += 3; break;
+            }
+        }
+    }
+
+    // Runs once at open time; afterwards every accessor trusts the bytes.
+    void validate() const {
+        if(size_ < sizeof(RosterHeader) || std::memcmp(header().magic, kRosterMagic, 8) != 0)
+            throw std::runtime_error("Not a roster image");
+        const RosterHeader& h = header();
+        if(h.version != kRosterVersion) throw std::runtime_error("Unsupported roster image version");
+        uint64_t fightersEnd = h.fightersOff + uint64_t(h.fighterCount) * sizeof(RosterFighterRec);
+        uint64_t abilitiesEnd = h.abilitiesOff + uint64_t(h.abilityCount) * sizeof(RosterAbilityRec);
+        uint64_t codeEnd = h.codeOff + uint64_t(h.codeWords) * sizeof(int32_t);
+        if(h.totalSize != size_ || h.fightersOff < sizeof(RosterHeader)
+           || (h.fightersOff | h.abilitiesOff | h.learnOff | h.codeOff) % 4 != 0
+           || fightersEnd > h.abilitiesOff || abilitiesEnd > h.learnOff || h.learnOff > h.codeOff
+           || codeEnd > h.stringsOff || h.stringsOff > size_)
+            corrupt("bad section layout");
+
+        const uint64_t learnTotal = (h.codeOff - h.learnOff) / sizeof(uint32_t);
+        const uint64_t stringsSize = size_ - h.stringsOff;
+        const uint32_t* learn = at<uint32_t>(h.learnOff);
+
+        std::vector<char> starts;
+        for(uint32_t a = 0; a < h.abilityCount; ++a) {
+            const RosterAbilityRec& r = abilityRec(a);
+            if(uint64_t(r.nameOff) + r.nameLen > stringsSize) corrupt("ability name out of range");
+            if(uint64_t(r.codeFirst) + r.codeLen > h.codeWords) corrupt("ability code out of range");
+            if(a > 0 && abilityName(a - 1).compare(abilityName(a).data, abilityName(a).size) >= 0) corrupt("abilities not sorted");
+            validateCode(code() + r.codeFirst, r.codeLen, starts);
+        }
+        for(uint32_t i = 0; i < h.fighterCount; ++i) {
+            const RosterFighterRec& r = fighterRec(i);
+            if(uint64_t(r.nameOff) + r.nameLen > stringsSize) corrupt("fighter name out of range");
+            if(r.type > static_cast<uint32_t>(FighterType::Evasive)) corrupt("bad fighter type");
+            if(uint64_t(r.learnFirst) + r.learnCount > learnTotal) corrupt("learn-set out of range");
+            for(uint32_t k = 0; k < r.learnCount; ++k)
+                if(learn[r.learnFirst + k] >= h.abilityCount) corrupt("learn-set names a missing ability");
+            if(i > 0 && fighterName(i - 1).compare(fighterName(i).data, fighterName(i).size) >= 0) corrupt("fighters not sorted");
+        }
+    }
+
+public:
+    RosterImage() {}
+    RosterImage(const RosterImage&) = delete;
+    RosterImage& operator=(const RosterImage&) = delete;
+    ~RosterImage() { close(); }
+
+    // Uses a caller-owned buffer in place; it must stay alive and 4-byte aligned.
+    void attach(const char* data, size_t size) {
+        close();
+        base_ = data; size_ = size;
+        validate();
+    }
+
+    void open(const std::string& path) {
+        close();
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) throw std::runtime_error("Cannot open roster image: " + path);
+        struct stat st;
+        if(fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); throw std::runtime_error("Cannot open roster image: " + path); }
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if(p == MAP_FAILED) throw std::runtime_error("Cannot map roster image: " + path);
+        map_ = p;
+        base_ = static_cast<const char*>(p);
+        size_ = static_cast<size_t>(st.st_size);
+#else
+        std::ifstream in(path, std::ios::binary);
+        if(!in) throw std::runtime_error("Cannot open roster image: " + path);
+        owned_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        base_ = owned_.data();
+        size_ = owned_.size();
+#endif
+        try { validate(); } catch(...) { close(); throw; }
+    }
+
+    void close() {
+#ifndef _WIN32
+        if(map_) munmap(map_, size_);
+        map_ = nullptr;
+#endif
+        owned_.clear();
+        base_ = nullptr; size_ = 0;
+    }
+
+    bool isOpen() const { return base_ != nullptr; }
+    uint32_t fighterCount() const { return header().fighterCount; }
+    uint32_t abilityCount() const { return header().abilityCount; }
+
+    const RosterFighterRec& fighterRec(uint32_t i) const { return at<RosterFighterRec>(header().fightersOff)[i]; }
+    const RosterAbilityRec& abilityRec(uint32_t i) const { return at<RosterAbilityRec>(header().abilitiesOff)[i]; }
+    RosterStr text(uint32_t off, uint32_t len) const { return RosterStr{base_ + header().stringsOff + off, len}; }
+    RosterStr fighterName(uint32_t i) const { return text(fighterRec(i).nameOff, fighterRec(i).nameLen); }
+    RosterStr abilityName(uint32_t i) const { return text(abilityRec(i).nameOff, abilityRec(i).nameLen); }
+    const uint32_t* learnSet(uint32_t i) const { return at<uint32_t>(header().learnOff) + fighterRec(i).learnFirst; }
+    const int32_t* code() const { return at<int32_t>(header().codeOff); }
+
+    // Binary search over the name-sorted fighter table; -1 when missing.
+    int64_t findFighter(const std::string& name) const {
+        uint32_t lo = 0, hi = fighterCount();
+        while(lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            int c = fighterName(mid).compare(name.data(), name.size());
+            if(c == 0) return mid;
+            if(c < 0) lo = mid + 1; else hi = mid;
+        }
+        return -1;
+    }
+
+    int64_t findAbility(const std::string& name) const {
+        uint32_t lo = 0, hi = abilityCount();
+        while(lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            int c = abilityName(mid).compare(name.data(), name.size());
+            if(c == 0) return mid;
+            if(c < 0) lo = mid + 1; else hi = mid;
+        }
+        return -1;
+    }
+
+    Fighter makeFighter(uint32_t i) const {
+        const RosterFighterRec& r = fighterRec(i);
+        Fighter f(fighterName(i).str(), typeToStr(static_cast<FighterType>(r.type)), r.hp);
+        const uint32_t* learn = learnSet(i);
+        for(uint32_t k = 0; k < r.learnCount; ++k) f.addAbility(abilityName(learn[k]).str());
+        return f;
+    }
+
+    void castAbility(uint32_t a, Fighter& attacker, Fighter& defender, int round, ActionContext& ctx) const {
+        const RosterAbilityRec& r = abilityRec(a);
+        runRosterCode(code() + r.codeFirst, 0, r.codeLen, attacker, defender, round, ctx);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Text -> image compiler.
+
+inline std::vector<char> compileRoster(std::istream& in) {
+    struct Ability { std::string name; std::vector<int32_t> code; };
+    struct Entry { std::string name; uint32_t type; int32_t hp; std::vector<std::string> learn; };
+    struct Block { int kind; size_t patch; };   // kind: 0 ability, 1 if, 2 else, 3 repeat/delay
+
+    std::vector<Ability> abilities;
+    std::vector<Entry> entries;
+    std::map<std::string, size_t> entryIndex;
+    std::vector<Block> blocks;
+    int lineNo = 0;
+    std::string line;
+
+    auto fail = [&](const std::string& msg) -> void {
+        throw std::runtime_error("roster line " + std::to_string(lineNo) + ": " + msg);
+    };
+    auto toInt = [&](const std::string& s) -> int32_t {
+        try { size_t n; long v = std::stol(s, &n); if(n == s.size()) return static_cast<int32_t>(v); } catch(...) {}
+        fail("expected a number, got '" + s + "'");
+        return 0;
+    };
+    auto status = [&](const std::string& s) -> int32_t {
+        static const char* names[] = {"stun", "shield", "buff", "poison"};
+        for(int i = 0; i < kStatusCount; ++i) if(s == names[i]) return i;
+        fail("unknown status '" + s + "'");
+        return 0;
+    };
+    auto who = [&](const std::string& s) -> int32_t {
+        if(s == "attacker") return 0;
+        if(s == "defender") return 1;
+        fail("expected attacker or defender, got '" + s + "'");
+        return 0;
+    };
+
+    while(std::getline(in, line)) {
+        ++lineNo;
+        size_t hash = line.find('#');
+        if(hash != std::string::npos) line.erase(hash);
+        std::istringstream ls(line);
+        std::vector<std::string> tok;
+        for(std::string t; ls >> t;) tok.push_back(t);
+        if(tok.empty()) continue;
+        const std::string& kw = tok[0];
+        std::vector<int32_t>* code = blocks.empty() ? nullptr : &abilities.back().code;
+
+        if(!code) {
+            if(kw == "ability" && tok.size() == 2) {
+                abilities.push_back({tok[1], {}});
+                blocks.push_back({0, 0});
+            } else if(kw == "fighter" && tok.size() >= 4) {
+                if(entryIndex.count(tok[1])) fail("duplicate fighter '" + tok[1] + "'");
+                uint32_t type = 0;
+                try { type = static_cast<uint32_t>(strToType(tok[2])); } catch(const std::invalid_argument& e) { fail(e.what()); }
+                entryIndex[tok[1]] = entries.size();
+                entries.push_back({tok[1], type, toInt(tok[3]), std::vector<std::string>(tok.begin() + 4, tok.end())});
+            } else if(kw == "learn" && tok.size() >= 3) {
+                auto it = entryIndex.find(tok[1]);
+                if(it == entryIndex.end()) fail("unknown fighter '" + tok[1] + "'");
+                entries[it->second].learn.insert(entries[it->second].learn.end(), tok.begin() + 2, tok.end());
+            } else {
+                fail("unexpected '" + kw + "'");
+            }
+            continue;
+        }
+
+        if((kw == "damage" || kw == "heal") && tok.size() == 3) {
+            code->insert(code->end(), {static_cast<int32_t>(kw == "damage" ? RosterOp::Damage : RosterOp::Heal), who(tok[1]), toInt(tok[2])});
+        } else if(kw == "tag" && tok.size() == 3 && (tok[2] == "in" || tok[2] == "out")) {
+            code->insert(code->end(), {static_cast<int32_t>(RosterOp::Tag), who(tok[1]), tok[2] == "in" ? 1 : 0});
+        } else if(kw == "apply" && tok.size() == 4) {
+            code->insert(code->end(), {static_cast<int32_t>(RosterOp::Apply), who(tok[1]), status(tok[2]), toInt(tok[3])});
+        } else if((kw == "for" || kw == "after") && tok.size() == 2) {
+            blocks.push_back({3, code->size() + 2});
+            code->insert(code->end(), {static_cast<int32_t>(kw == "for" ? RosterOp::Repeat : RosterOp::Delay), toInt(tok[1]), 0});
+        } else if(kw == "if" && tok.size() >= 3) {
+            size_t i = 1;
+            int32_t negate = 0;
+            if(tok[i] == "not") { negate = 1; ++i; }
+            std::vector<int32_t> cond;
+            if(tok[i] == "hp" && tok.size() == i + 4) {
+                static const char* ops[] = {"<", "<=", ">", ">=", "==", "!="};
+                int32_t cmp = 0;
+                for(int k = 0; k < 6; ++k) if(tok[i + 2] == ops[k]) cmp = k + 1;
+                if(!cmp) fail("unknown comparison '" + tok[i + 2] + "'");
+                cond = {static_cast<int32_t>(RosterCond::Hp), who(tok[i + 1]), cmp, toInt(tok[i + 3])};
+            } else if(tok[i] == "out" && tok.size() == i + 2) {
+                cond = {static_cast<int32_t>(RosterCond::Out), who(tok[i + 1]), 0, 0};
+            } else if(tok[i] == "type" && tok.size() == i + 3) {
+                int32_t type = 0;
+                try { type = static_cast<int32_t>(strToType(tok[i + 2])); } catch(const std::invalid_argument& e) { fail(e.what()); }
+                cond = {static_cast<int32_t>(RosterCond::Type), who(tok[i + 1]), 0, type};
+            } else if(tok[i] == "status" && tok.size() == i + 3) {
+                cond = {static_cast<int32_t>(RosterCond::Status), who(tok[i + 1]), 0, status(tok[i + 2])};
+            } else {
+                fail("malformed condition");
+            }
+            code->push_back(static_cast<int32_t>(RosterOp::JumpUnless));
+            code->insert(code->end(), cond.begin(), cond.end());
+            code->push_back(negate);
+            blocks.push_back({1, code->size()});
+            code->push_back(0);
+        } else if(kw == "else" && tok.size() == 1 && blocks.back().kind == 1) {
+            size_t patch = blocks.back().patch;
+            code->insert(code->end(), {static_cast<int32_t>(RosterOp::Jump), 0});
+            (*code)[patch] = static_cast<int32_t>(code->size());
+            blocks.back() = {2, code->size() - 1};
+        } else if(kw == "end" && tok.size() == 1) {
+            Block b = blocks.back();
+            blocks.pop_back();
+            if(b.kind != 0) (*code)[b.patch] = static_cast<int32_t>(code->size());
+        } else {
+            fail("unexpected '" + kw + "' in ability '" + abilities.back().name + "'");
+        }
+    }
+    if(!blocks.empty()) fail("missing 'end'");
+
+    std::sort(abilities.begin(), abilities.end(), [](const Ability& a, const Ability& b) { return a.name < b.name; });
+    for(size_t i = 1; i < abilities.size(); ++i)
+        if(abilities[i].name == abilities[i - 1].name) throw std::runtime_error("duplicate ability '" + abilities[i].name + "'");
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.name < b.name; });
+
+    std::string strings;
+    auto addString = [&](const std::string& s) { uint32_t off = static_cast<uint32_t>(strings.size()); strings += s; return off; };
+
+    std::vector<RosterAbilityRec> abilityRecs;
+    std::vector<int32_t> code;
+    for(const auto& a : abilities) {
+        abilityRecs.push_back({addString(a.name), static_cast<uint32_t>(a.name.size()),
+                               static_cast<uint32_t>(code.size()), static_cast<uint32_t>(a.code.size())});
+        code.insert(code.end(), a.code.begin(), a.code.end());
+    }
+
+    std::vector<RosterFighterRec> fighterRecs;
+    std::vector<uint32_t> learn;
+    for(const auto& e : entries) {
+        RosterFighterRec r = {addString(e.name), static_cast<uint32_t>(e.name.size()), e.type, e.hp,
+                              static_cast<uint32_t>(learn.size()), static_cast<uint32_t>(e.learn.size())};
+        for(const auto& n : e.learn) {
+            auto it = std::lower_bound(abilities.begin(), abilities.end(), n,
+                                       [](const Ability& a, const std::string& s) { return a.name < s; });
+            if(it == abilities.end() || it->name != n)
+                throw std::runtime_error("fighter '" + e.name + "' learns unknown ability '" + n + "'");
+            learn.push_back(static_cast<uint32_t>(it - abilities.begin()));
+        }
+        fighterRecs.push_back(r);
+    }
+
+    RosterHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, kRosterMagic, 8);
+    h.version = kRosterVersion;
+    h.fighterCount = static_cast<uint32_t>(fighterRecs.size());
+    h.abilityCount = static_cast<uint32_t>(abilityRecs.size());
+    h.fightersOff = sizeof(RosterHeader);
+    h.abilitiesOff = h.fightersOff + static_cast<uint32_t>(fighterRecs.size() * sizeof(RosterFighterRec));
+    h.learnOff = h.abilitiesOff + static_cast<uint32_t>(abilityRecs.size() * sizeof(RosterAbilityRec));
+    h.codeOff = h.learnOff + static_cast<uint32_t>(learn.size() * sizeof(uint32_t));
+    h.codeWords = static_cast<uint32_t>(code.size());
+    h.stringsOff = h.codeOff + static_cast<uint32_t>(code.size() * sizeof(int32_t));
+    h.totalSize = h.stringsOff + static_cast<uint32_t>(strings.size());
+
+    std::vector<char> image(h.totalSize);
+    auto put = [&](uint32_t off, const void* p, size_t n) { if(n) std::memcpy(image.data() + off, p, n); };
+    put(0, &h, sizeof(h));
+    put(h.fightersOff, fighterRecs.data(), fighterRecs.size() * sizeof(RosterFighterRec));
+    put(h.abilitiesOff, abilityRecs.data(), abilityRecs.size() * sizeof(RosterAbilityRec));
+    put(h.learnOff, learn.data(), learn.size() * sizeof(uint32_t));
+    put(h.codeOff, code.data(), code.size() * sizeof(int32_t));
+    put(h.stringsOff, strings.data(), strings.size());
+    return image;
+}
+
+inline void compileRosterFile(const std::string& src, const std::string& dst) {
+    std::ifstream in(src);
+    if(!in) throw std::runtime_error("Cannot open roster file: " + src);
+    std::vector<char> image = compileRoster(in);
+    std::ofstream out(dst, std::ios::binary);
+    out.write(image.data(), static_cast<std::streamsize>(image.size()));
+    if(!out) throw std::runtime_error("Cannot write roster image: " + dst);
+}
+
+// ---------------------------------------------------------------------------
+// Using an image at runtime. Images stay mapped for the life of the program.
+
+inline std::vector<std::unique_ptr<RosterImage>>& g_rosterImages() {
+    static std::vector<std::unique_ptr<RosterImage>> v; return v;
+}
+
+// Serves runDuel() straight from the image: names are listed and looked up
+// in place and only the two selected fighters are turned into Fighters.
+inline DuelSource rosterDuelSource(const RosterImage& img) {
+    const RosterImage* p = &img;
+    DuelSource s;
+    s.count = [p] { return static_cast<size_t>(p->fighterCount()); };
+    s.list = [p](std::ostream& os) {
+        for(uint32_t i = 0; i < p->fighterCount(); ++i) {
+            RosterStr n = p->fighterName(i);
+            os.write(n.data, n.size);
+            os << "\n";
+        }
+    };
+    s.find = [p](const std::string& n, Fighter& out) {
+        int64_t i = p->findFighter(n);
+        if(i < 0) return false;
+        out = p->makeFighter(static_cast<uint32_t>(i));
+        return true;
+    };
+    s.cast = [p](const std::string& a, Fighter& att, Fighter& def, int round, ActionContext& ctx) {
+        int64_t i = p->findAbility(a);
+        if(i >= 0) p->castAbility(static_cast<uint32_t>(i), att, def, round, ctx);
+    };
+    return s;
+}
+
+// Copies every record into g_fighters()/g_abilities() for the modes that
+// read the registries (LADDER, TOURNAMENT, STATS, TRAIN_POLICY). This is
+// the same O(n) insertion cost as the macro path; DUEL does not need it.
+// The image must stay open: the registered abilities run its code.
+inline void installRoster(const RosterImage& img) {
+    for(uint32_t a = 0; a < img.abilityCount(); ++a) {
+        const RosterImage* p = &img;
+        regAbility(img.abilityName(a).str(), [p, a](Fighter& att, Fighter& def, int round, ActionContext& ctx) {
+            p->castAbility(a, att, def, round, ctx);
+        });
+    }
+    for(uint32_t i = 0; i < img.fighterCount(); ++i) regFighter(img.makeFighter(i));
+}
+
+// Maps the image and points runDuel() at it; nothing is copied.
+inline const RosterImage& loadRoster(const std::string& path) {
+    std::unique_ptr<RosterImage> img(new RosterImage());
+    img->open(path);
+    g_rosterImages().push_back(std::move(img));
+    g_duelSource() = rosterDuelSource(*g_rosterImages().back());
+    return *g_rosterImages().back();
+}
+
+// Maps the image and installs it into the registries.
+inline const RosterImage& installRosterFile(const std::string& path) {
+    std::unique_ptr<RosterImage> img(new RosterImage());
+    img->open(path);
+    g_rosterImages().push_back(std::move(img));
+    installRoster(*g_rosterImages().back());
+    return *g_rosterImages().back();
+}
+
+#define LOAD_ROSTER(path) ,false)){} loadRoster(path); if(false){}else if((_FInit_{"_END_","Rushdown",1}
+#define INSTALL_ROSTER(path) ,false)){} installRosterFile(path); if(false){}else if((_FInit_{"_END_","Rushdown",1}
+
+#endif
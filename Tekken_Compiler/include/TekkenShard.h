@@ -0,0 +1,370 @@
+#ifndef TEKKEN_SHARD_H
+#define TEKKEN_SHARD_H
+
+#include "TekkenStats.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Multi-process tournament: the coordinator forks worker processes that
+// inherit the registered roster, hands them pairing shards over pipes and
+// merges the result each shard sends back into one DuelStats. Shards are cut lazily from a
+// (p1, p2, offset) cursor, so only in-flight and re-queued shards are held.
+// A worker killed by a crashing ability, or killed for overrunning the
+// per-shard timeout, only loses its in-flight shard, which is re-queued on a
+// fresh worker.
+//
+// Frames are [u32 payload length][u8 kind][payload], native byte order. A
+// Work payload is a ShardWork; a Result payload is the shard id followed by
+// a serialized two-fighter DuelStats (Player1 = 0, Player2 = 1), so its size
+// depends on the ability count only, not on the roster.
+
+enum class ShardFrame : uint8_t { Work = 1, Result = 2, Quit = 3 };
+
+struct ShardWork {
+    uint32_t id;
+    uint32_t p1, p2;     // indices into rosterNames()
+    uint32_t duels;
+    uint64_t seed;
+};
+
+struct TournamentReport {
+    std::vector<std::string> names;
+    DuelStats stats;
+    uint64_t shards = 0;
+    uint64_t failedShards = 0;
+    uint32_t workerCrashes = 0;
+    uint32_t shardTimeouts = 0;
+};
+
+#ifndef _WIN32
+
+inline bool shardWriteAll(int fd, const void* p, size_t n) {
+    const char* c = static_cast<const char*>(p);
+    while(n) {
+        ssize_t w = ::write(fd, c, n);
+        if(w < 0 && errno == EINTR) continue;
+        if(w <= 0) return false;
+        c += w; n -= static_cast<size_t>(w);
+    }
+    return true;
+}
+
+inline bool shardReadAll(int fd, void* p, size_t n) {
+    char* c = static_cast<char*>(p);
+    while(n) {
+        ssize_t r = ::read(fd, c, n);
+        if(r < 0 && errno == EINTR) continue;
+        if(r <= 0) return false;
+        c += r; n -= static_cast<size_t>(r);
+    }
+    return true;
+}
+
+inline bool shardSend(int fd, ShardFrame kind, const void* payload, uint32_t len) {
+    char head[5];
+    std::memcpy(head, &len, 4);
+    head[4] = static_cast<char>(kind);
+    return shardWriteAll(fd, head, 5) && (len == 0 || shardWriteAll(fd, payload, len));
+}
+
+// Reads one frame into `payload` (at most `cap` bytes); false on EOF or a
+// malformed frame.
+inline bool shardRecv(int fd, ShardFrame& kind, std::vector<char>& payload, uint32_t cap) {
+    char head[5];
+    if(!shardReadAll(fd, head, 5)) return false;
+    uint32_t len;
+    std::memcpy(&len, head, 4);
+    kind = static_cast<ShardFrame>(head[4]);
+    if(len > cap) return false;
+    payload.resize(len);
+    return len == 0 || shardReadAll(fd, payload.data(), len);
+}
+
+inline void shardWorkerLoop(int in, int out, const std::vector<Fighter>& roster,
+                            const std::vector<std::vector<int32_t>>& ids, uint32_t abilities) {
+    ShardFrame kind;
+    ShardWork work;
+    std::vector<char> buf;
+    while(shardRecv(in, kind, buf, sizeof(work)) && kind == ShardFrame::Work && buf.size() == sizeof(work)) {
+        std::memcpy(&work, buf.data(), sizeof(work));
+        if(work.p1 >= roster.size() || work.p2 >= roster.size()) break;
+        const Fighter& f1 = roster[work.p1];
+        const Fighter& f2 = roster[work.p2];
+        DuelStats stats(2, abilities);
+        DuelController c1 = countingController(randomController, &ids[work.p1], &stats);
+        DuelController c2 = countingController(randomController, &ids[work.p2], &stats);
+        for(uint32_t k = 0; k < work.duels; ++k) {
+            stats.record(0, 1, simulateDuel(f1, f2, c1, c2, mixSeed(work.seed, k)), f1.getMaxHP(), f2.getMaxHP());
+        }
+        buf.resize(sizeof(uint32_t));
+        std::memcpy(buf.data(), &work.id, sizeof(uint32_t));
+        stats.serialize(buf);
+        if(!shardSend(out, ShardFrame::Result, buf.data(), static_cast<uint32_t>(buf.size()))) break;
+    }
+}
+
+class TournamentCoordinator {
+    typedef std::chrono::steady_clock Clock;
+    struct Worker {
+        pid_t pid = -1;
+        int toWorker = -1, fromWorker = -1;
+        bool busy = false;
+        ShardWork work;
+        uint32_t attempts = 0;
+        Clock::time_point deadline;
+    };
+    struct Retry { ShardWork work; uint32_t attempts; };
+
+    std::vector<Fighter> roster_;
+    std::vector<std::vector<int32_t>> learnIds_;
+    uint32_t abilities_ = 0;
+    std::vector<Worker> workers_;
+    std::deque<Retry> retries_;
+    unsigned workerCount_;
+    uint32_t maxAttempts_;
+    std::chrono::milliseconds shardTimeout_;
+
+    // Shard cursor: the next shard covers duels [offset_, offset_ + shardSize_)
+    // of pairing (p1_, p2_).
+    uint32_t fighters_ = 0, duelsPerPairing_ = 0, shardSize_ = 1;
+    uint32_t p1_ = 0, p2_ = 0, offset_ = 0, nextId_ = 0;
+    uint64_t seed_ = 1;
+
+    bool nextShard(ShardWork& w) {
+        while(p1_ < fighters_ && (p1_ == p2_ || offset_ >= duelsPerPairing_)) {
+            offset_ = 0;
+            if(++p2_ == fighters_) { p2_ = 0; ++p1_; }
+        }
+        if(p1_ >= fighters_) return false;
+        uint32_t count = std::min(shardSize_, duelsPerPairing_ - offset_);
+        w = ShardWork{nextId_, p1_, p2_, count, mixSeed(seed_, nextId_)};
+        nextId_++;
+        offset_ += count;
+        return true;
+    }
+
+    bool spawn(Worker& w) {
+        int down[2], up[2];
+        if(pipe(down) != 0) return false;
+        if(pipe(up) != 0) { ::close(down[0]); ::close(down[1]); return false; }
+        std::cout.flush();
+        pid_t pid = fork();
+        if(pid < 0) {
+            ::close(down[0]); ::close(down[1]); ::close(up[0]); ::close(up[1]);
+            return false;
+        }
+        if(pid == 0) {
+            ::close(down[1]); ::close(up[0]);
+            for(const auto& o : workers_) { if(o.pid > 0) { ::close(o.toWorker); ::close(o.fromWorker); } }
+            int devnull = ::open("/dev/null", O_WRONLY);
+            if(devnull >= 0) { dup2(devnull, STDOUT_FILENO); ::close(devnull); }
+            shardWorkerLoop(down[0], up[1], roster_, learnIds_, abilities_);
+            _exit(0);
+        }
+        ::close(down[0]); ::close(up[1]);
+        w.pid = pid; w.toWorker = down[1]; w.fromWorker = up[0]; w.busy = false;
+        return true;
+    }
+
+    void retire(Worker& w) {
+        ::close(w.toWorker); ::close(w.fromWorker);
+        int status = 0;
+        waitpid(w.pid, &status, 0);
+        w.pid = -1;
+    }
+
+    // Re-queued shards go first. A failed send is picked up by poll() as EOF
+    // on the worker's pipe.
+    void dispatch(Worker& w) {
+        if(w.busy) return;
+        if(!retries_.empty()) {
+            w.work = retries_.front().work;
+            w.attempts = retries_.front().attempts;
+            retries_.pop_front();
+        } else if(nextShard(w.work)) {
+            w.attempts = 0;
+        } else {
+            return;
+        }
+        w.busy = true;
+        w.deadline = Clock::now() + shardTimeout_;
+        shardSend(w.toWorker, ShardFrame::Work, &w.work, sizeof(ShardWork));
+    }
+
+    void requeue(Worker& w, TournamentReport& rep) {
+        if(!w.busy) return;
+        w.busy = false;
+        if(w.attempts + 1 < maxAttempts_) retries_.push_back({w.work, w.attempts + 1});
+        else rep.failedShards++;
+    }
+
+    void restart(Worker& w, TournamentReport& rep) {
+        requeue(w, rep);
+        retire(w);
+        if(!spawn(w)) throw std::runtime_error("Cannot restart tournament worker");
+    }
+
+    // Ignores SIGPIPE for the duration of run() and, however run() exits,
+    // stops every live worker: idle ones get Quit, busy ones are killed.
+    class Session {
+        TournamentCoordinator& c_;
+        void (*oldPipe_)(int);
+    public:
+        explicit Session(TournamentCoordinator& c) : c_(c), oldPipe_(std::signal(SIGPIPE, SIG_IGN)) {}
+        Session(const Session&) = delete;
+        Session& operator=(const Session&) = delete;
+        ~Session() {
+            for(auto& w : c_.workers_) {
+                if(w.pid <= 0) continue;
+                if(w.busy) ::kill(w.pid, SIGKILL);
+                else shardSend(w.toWorker, ShardFrame::Quit, nullptr, 0);
+                c_.retire(w);
+            }
+            c_.workers_.clear();
+            std::signal(SIGPIPE, oldPipe_);
+        }
+    };
+
+public:
+    TournamentCoordinator(unsigned workers, uint32_t maxAttempts = 3,
+                          std::chrono::milliseconds shardTimeout = std::chrono::milliseconds(60000))
+        : workerCount_(workers ? workers : 1), maxAttempts_(maxAttempts ? maxAttempts : 1),
+          shardTimeout_(shardTimeout) {}
+
+    TournamentReport run(uint32_t duelsPerPairing, uint32_t shardSize = 500, uint64_t seed = 1) {
+        TournamentReport rep;
+        rep.names = rosterNames();
+        size_t n = rep.names.size();
+        roster_.clear();
+        for(const auto& name : rep.names) roster_.push_back(getFighter(name));
+        learnIds_ = learnSetIds(roster_);
+        abilities_ = static_cast<uint32_t>(g_abilities().size());
+        rep.stats = DuelStats(static_cast<uint32_t>(n), abilities_);
+        const uint32_t resultCap = static_cast<uint32_t>(sizeof(uint32_t) + DuelStats::serializedSize(abilities_, 1));
+
+        fighters_ = static_cast<uint32_t>(n);
+        duelsPerPairing_ = duelsPerPairing;
+        shardSize_ = shardSize ? shardSize : 1;
+        p1_ = p2_ = offset_ = nextId_ = 0;
+        seed_ = seed;
+        retries_.clear();
+        uint64_t perPairing = (static_cast<uint64_t>(duelsPerPairing) + shardSize_ - 1) / shardSize_;
+        rep.shards = n > 1 ? static_cast<uint64_t>(n) * (n - 1) * perPairing : 0;
+        if(rep.shards == 0) return rep;
+
+        Session session(*this);
+        workers_.assign(static_cast<size_t>(std::min<uint64_t>(workerCount_, rep.shards)), Worker());
+        for(auto& w : workers_) {
+            if(!spawn(w)) throw std::runtime_error("Cannot start tournament worker");
+        }
+
+        std::vector<pollfd> fds;
+        std::vector<char> buf;
+        DuelStats part;
+        for(;;) {
+            bool busy = false;
+            Clock::time_point wake = Clock::time_point::max();
+            for(auto& w : workers_) {
+                dispatch(w);
+                if(w.busy) { busy = true; wake = std::min(wake, w.deadline); }
+            }
+            if(!busy) break;
+
+            fds.clear();
+            for(const auto& w : workers_) fds.push_back({w.fromWorker, POLLIN, 0});
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(wake - Clock::now()).count();
+            int timeout = wait < 0 ? 0 : static_cast<int>(std::min<long long>(wait + 1, 1 << 30));
+            if(poll(fds.data(), fds.size(), timeout) < 0) {
+                if(errno == EINTR) continue;
+                throw std::runtime_error(std::string("Tournament poll failed: ") + std::strerror(errno));
+            }
+            Clock::time_point now = Clock::now();
+            for(size_t k = 0; k < workers_.size(); ++k) {
+                Worker& w = workers_[k];
+                if(!fds[k].revents) {
+                    // Overran the shard timeout: treated like a crash.
+                    if(w.busy && now >= w.deadline) {
+                        ::kill(w.pid, SIGKILL);
+                        rep.shardTimeouts++;
+                        restart(w, rep);
+                    }
+                    continue;
+                }
+                ShardFrame kind;
+                uint32_t id = 0;
+                bool ok = shardRecv(w.fromWorker, kind, buf, resultCap) && kind == ShardFrame::Result
+                          && buf.size() >= sizeof(id);
+                if(ok) std::memcpy(&id, buf.data(), sizeof(id));
+                if(ok && w.busy && w.work.id == id
+                   && part.deserialize(buf.data() + sizeof(id), buf.size() - sizeof(id))
+                   && part.sameShape(2, abilities_)) {
+                    rep.stats.mergePairing(part, w.work.p1, w.work.p2);
+                    w.busy = false;
+                    continue;
+                }
+                // EOF, a bad or wrongly shaped frame or a failed write: the
+                // worker is gone.
+                rep.workerCrashes++;
+                restart(w, rep);
+            }
+        }
+
+        return rep;
+    }
+};
+
+#endif
+
+inline void printTournament(const TournamentReport& rep) {
+    size_t n = rep.names.size();
+    std::cout << "\n--------------------------------TOURNAMENT---------------------------------\n";
+    std::cout << std::setw(12) << "";
+    for(size_t j = 0; j < n; ++j) std::cout << std::setw(10) << rep.names[j].substr(0, 9);
+    std::cout << "\n";
+    for(size_t i = 0; i < n; ++i) {
+        std::cout << std::left << std::setw(12) << rep.names[i].substr(0, 11) << std::right;
+        for(size_t j = 0; j < n; ++j) {
+            uint64_t g = n == rep.stats.fighters() ? rep.stats.games(i, j) : 0;
+            if(i == j || g == 0) { std::cout << std::setw(10) << "-"; continue; }
+            std::cout << std::setw(9) << std::fixed << std::setprecision(1)
+                      << 100.0 * rep.stats.wins(i, j) / g << "%";
+        }
+        std::cout << "\n";
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << "---------------------------------------------------------------------------\n";
+    std::cout << "Shards: " << rep.shards << "  Failed: " << rep.failedShards
+              << "  Worker crashes: " << rep.workerCrashes << "  Timeouts: " << rep.shardTimeouts << "\n";
+    printDuelSummary(rep.stats);
+}
+
+inline void runTournament(unsigned workers, uint32_t duelsPerPairing) {
+    if(rosterNames().empty()) {
+        std::cout << "No fighters available!\n";
+        return;
+    }
+#ifndef _WIN32
+    TournamentCoordinator coordinator(workers);
+    printTournament(coordinator.run(duelsPerPairing));
+#else
+    (void)workers; (void)duelsPerPairing;
+    std::cout << "Tournament mode needs fork() and is not available on this platform.\n";
+#endif
+}
+
+#define TOURNAMENT(workers, duels) ,false)){} runTournament(workers, duels); if(false){}else if((_FInit_{"_END_","Rushdown",1}
+
+#endif
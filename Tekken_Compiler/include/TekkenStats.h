@@ -0,0 +1,361 @@
+#ifndef TEKKEN_STATS_H
+#define TEKKEN_STATS_H
+
+#include "Tekken.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// Mergeable duel aggregates whose size does not grow with the number of
+// duels recorded. Pairing counters are sparse, one entry per pair of
+// fighters that actually met, so a DuelStats over random pairings of a large
+// roster only pays for the pairs it saw; collectDuelStats() bounds each
+// thread further by flushing into one shared DuelStats.
+//
+// Duel length is capped at runDuel()'s 100-round draw limit and the winner's
+// remaining HP is kept as a percentage of max HP, so both fit exact 101-bin
+// histograms and their quantiles need no approximation.
+
+class DuelStats {
+public:
+    static const int kBins = 101;
+
+    // Results between fighters lo <= hi; draws = games - winsLo - winsHi.
+    struct Pairing {
+        uint64_t games = 0, winsLo = 0, winsHi = 0;
+    };
+
+private:
+    uint32_t fighters_ = 0, abilities_ = 0;
+    std::unordered_map<uint64_t, Pairing> pairings_;   // keyed by pairKey(lo, hi)
+    std::vector<uint64_t> length_;   // rounds played, 1..100
+    std::vector<uint64_t> hpLeft_;   // winner's HP left, % of max
+    std::vector<uint64_t> uses_;     // by ability id, see abilityNames()
+    uint64_t duels_ = 0, draws_ = 0;
+
+    struct Record { uint32_t lo, hi; uint64_t games, winsLo, winsHi; };
+    static const size_t kHeadBytes = 3 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+
+    static uint64_t pairKey(uint32_t i, uint32_t j) {
+        return i < j ? (static_cast<uint64_t>(i) << 32) | j : (static_cast<uint64_t>(j) << 32) | i;
+    }
+
+    const Pairing* pairing(uint32_t i, uint32_t j) const {
+        auto it = pairings_.find(pairKey(i, j));
+        return it == pairings_.end() ? nullptr : &it->second;
+    }
+
+    static int quantile(const std::vector<uint64_t>& h, uint64_t total, double q) {
+        if(total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(std::ceil(q * total));
+        if(rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for(int b = 0; b < kBins; ++b) {
+            seen += h[b];
+            if(seen >= rank) return b;
+        }
+        return kBins - 1;
+    }
+
+    void mergeTotals(const DuelStats& o) {
+        for(int b = 0; b < kBins; ++b) { length_[b] += o.length_[b]; hpLeft_[b] += o.hpLeft_[b]; }
+        for(size_t i = 0; i < uses_.size(); ++i) uses_[i] += o.uses_[i];
+        duels_ += o.duels_;
+        draws_ += o.draws_;
+    }
+
+public:
+    DuelStats() : length_(kBins, 0), hpLeft_(kBins, 0) {}
+    DuelStats(uint32_t fighters, uint32_t abilities)
+        : fighters_(fighters), abilities_(abilities), length_(kBins, 0), hpLeft_(kBins, 0), uses_(abilities, 0) {}
+
+    uint32_t fighters() const { return fighters_; }
+    uint32_t abilities() const { return abilities_; }
+    uint64_t duels() const { return duels_; }
+    uint64_t draws() const { return draws_; }
+    uint64_t uses(uint32_t ability) const { return uses_[ability]; }
+    size_t pairings() const { return pairings_.size(); }
+
+    uint64_t games(uint32_t i, uint32_t j) const {
+        const Pairing* p = pairing(i, j);
+        return p ? p->games : 0;
+    }
+    // Duels i won against j.
+    uint64_t wins(uint32_t i, uint32_t j) const {
+        const Pairing* p = pairing(i, j);
+        return p ? (i <= j ? p->winsLo : p->winsHi) : 0;
+    }
+    uint64_t draws(uint32_t i, uint32_t j) const {
+        const Pairing* p = pairing(i, j);
+        return p ? p->games - p->winsLo - p->winsHi : 0;
+    }
+
+    // Pairs that met, as (lo, hi) in ascending order.
+    std::vector<std::pair<uint32_t, uint32_t>> pairingList() const {
+        std::vector<uint64_t> keys;
+        keys.reserve(pairings_.size());
+        for(const auto& e : pairings_) keys.push_back(e.first);
+        std::sort(keys.begin(), keys.end());
+        std::vector<std::pair<uint32_t, uint32_t>> out;
+        out.reserve(keys.size());
+        for(uint64_t k : keys) out.push_back({static_cast<uint32_t>(k >> 32), static_cast<uint32_t>(k)});
+        return out;
+    }
+
+    // a and b are the roster indices seated as Player1 and Player2.
+    void record(uint32_t a, uint32_t b, const DuelOutcome& o, int maxHp1, int maxHp2) {
+        duels_++;
+        Pairing& p = pairings_[pairKey(a, b)];
+        p.games++;
+        int rounds = o.rounds < 1 ? 1 : (o.rounds > kBins - 1 ? kBins - 1 : o.rounds);
+        length_[rounds]++;
+        if(o.winner == 0) { draws_++; return; }
+        uint32_t winner = o.winner == 1 ? a : b, loser = o.winner == 1 ? b : a;
+        (winner <= loser ? p.winsLo : p.winsHi)++;
+        int hp = o.winner == 1 ? o.hp1 : o.hp2, maxHp = o.winner == 1 ? maxHp1 : maxHp2;
+        int pct = maxHp > 0 ? hp * 100 / maxHp : 0;
+        hpLeft_[pct < 0 ? 0 : (pct > 100 ? 100 : pct)]++;
+    }
+
+    void countAbility(uint32_t ability) { if(ability < abilities_) uses_[ability]++; }
+
+    bool sameShape(uint32_t fighters, uint32_t abilities) const {
+        return fighters_ == fighters && abilities_ == abilities;
+    }
+
+    void merge(const DuelStats& o) {
+        if(!sameShape(o.fighters_, o.abilities_))
+            throw std::invalid_argument("Cannot merge DuelStats of different shapes");
+        for(const auto& e : o.pairings_) {
+            Pairing& p = pairings_[e.first];
+            p.games += e.second.games;
+            p.winsLo += e.second.winsLo;
+            p.winsHi += e.second.winsHi;
+        }
+        mergeTotals(o);
+    }
+
+    // Merges a two-fighter DuelStats whose fighters 0 and 1 are this one's
+    // a and b (a != b).
+    void mergePairing(const DuelStats& o, uint32_t a, uint32_t b) {
+        if(o.fighters_ != 2 || o.abilities_ != abilities_ || a == b || a >= fighters_ || b >= fighters_)
+            throw std::invalid_argument("Cannot merge DuelStats of different shapes");
+        Pairing& p = pairings_[pairKey(a, b)];
+        p.games += o.games(0, 1);
+        p.winsLo += o.wins(a < b ? 0 : 1, a < b ? 1 : 0);
+        p.winsHi += o.wins(a < b ? 1 : 0, a < b ? 0 : 1);
+        mergeTotals(o);
+    }
+
+    void clear() { *this = DuelStats(fighters_, abilities_); }
+
+    int lengthQuantile(double q) const { return quantile(length_, duels_, q); }
+    int hpLeftQuantile(double q) const { return quantile(hpLeft_, duels_ - draws_, q); }
+
+    // Wilson score interval for the share of i-vs-j duels that i won.
+    std::pair<double, double> winRateInterval(uint32_t i, uint32_t j, double z = 1.96) const {
+        double n = static_cast<double>(games(i, j));
+        if(n == 0) return {0.0, 1.0};
+        double p = wins(i, j) / n, z2 = z * z;
+        double centre = (p + z2 / (2 * n)) / (1 + z2 / n);
+        double half = z * std::sqrt(p * (1 - p) / n + z2 / (4 * n * n)) / (1 + z2 / n);
+        return {centre - half, centre + half};
+    }
+
+    // [u32 fighters][u32 abilities][u32 pairings][u64 duels][u64 draws]
+    // [pairing records][length bins][HP bins][ability uses]
+    static size_t serializedSize(uint32_t abilities, size_t pairings) {
+        return kHeadBytes + pairings * sizeof(Record) + (2 * kBins + static_cast<size_t>(abilities)) * sizeof(uint64_t);
+    }
+
+    void serialize(std::vector<char>& out) const {
+        uint32_t head[3] = {fighters_, abilities_, static_cast<uint32_t>(pairings_.size())};
+        uint64_t totals[2] = {duels_, draws_};
+        size_t start = out.size();
+        out.resize(start + serializedSize(abilities_, pairings_.size()));
+        char* p = out.data() + start;
+        auto put = [&p](const void* src, size_t n) { std::memcpy(p, src, n); p += n; };
+        put(head, sizeof(head));
+        put(totals, sizeof(totals));
+        for(const auto& e : pairings_) {
+            Record r{static_cast<uint32_t>(e.first >> 32), static_cast<uint32_t>(e.first),
+                     e.second.games, e.second.winsLo, e.second.winsHi};
+            put(&r, sizeof(r));
+        }
+        put(length_.data(), kBins * sizeof(uint64_t));
+        put(hpLeft_.data(), kBins * sizeof(uint64_t));
+        put(uses_.data(), uses_.size() * sizeof(uint64_t));
+    }
+
+    // Returns false when `size` does not match the encoded shape or a
+    // record is out of range. The size is checked before anything is
+    // allocated, so a garbled header cannot force a huge allocation.
+    bool deserialize(const char* p, size_t size) {
+        uint32_t head[3];
+        if(size < kHeadBytes) return false;
+        std::memcpy(head, p, sizeof(head));
+        size_t fixed = kHeadBytes + 2 * kBins * sizeof(uint64_t);
+        if(size < fixed || head[1] > (size - fixed) / sizeof(uint64_t)) return false;
+        size_t rest = size - fixed - head[1] * sizeof(uint64_t);
+        if(rest != static_cast<size_t>(head[2]) * sizeof(Record)) return false;
+
+        DuelStats s(head[0], head[1]);
+        p += sizeof(head);
+        auto get = [&p](void* dst, size_t n) { std::memcpy(dst, p, n); p += n; };
+        get(&s.duels_, sizeof(uint64_t));
+        get(&s.draws_, sizeof(uint64_t));
+        s.pairings_.reserve(head[2]);
+        for(uint32_t k = 0; k < head[2]; ++k) {
+            Record r;
+            get(&r, sizeof(r));
+            if(r.lo > r.hi || r.hi >= s.fighters_ || r.winsLo > r.games || r.winsHi > r.games - r.winsLo)
+                return false;
+            Pairing& e = s.pairings_[pairKey(r.lo, r.hi)];
+            e.games += r.games;
+            e.winsLo += r.winsLo;
+            e.winsHi += r.winsHi;
+        }
+        get(s.length_.data(), kBins * sizeof(uint64_t));
+        get(s.hpLeft_.data(), kBins * sizeof(uint64_t));
+        get(s.uses_.data(), s.uses_.size() * sizeof(uint64_t));
+        *this = std::move(s);
+        return true;
+    }
+};
+
+// Ability ids used by DuelStats: position in g_abilities() order.
+inline std::vector<std::string> abilityNames() {
+    std::vector<std::string> names;
+    for(const auto& a : g_abilities()) names.push_back(a.first);
+    return names;
+}
+
+// Learn-set of each roster fighter translated to ability ids (or -1 for a
+// name that is not registered).
+inline std::vector<std::vector<int32_t>> learnSetIds(const std::vector<Fighter>& roster) {
+    std::vector<std::string> names = abilityNames();
+    std::vector<std::vector<int32_t>> ids;
+    for(const auto& f : roster) {
+        ids.push_back({});
+        for(const auto& a : f.getAbilities()) {
+            auto it = std::lower_bound(names.begin(), names.end(), a);
+            ids.back().push_back(it != names.end() && *it == a ? static_cast<int32_t>(it - names.begin()) : -1);
+        }
+    }
+    return ids;
+}
+
+// Wraps a controller so every move it picks is counted in `stats`.
+inline DuelController countingController(const DuelController& base, const std::vector<int32_t>* ids, DuelStats* stats) {
+    return [base, ids, stats](const Fighter& self, const Fighter& foe, int round, const ActionContext& ctx, DuelRng& rng) {
+        int pick = base(self, foe, round, ctx, rng);
+        if(pick >= 0 && pick < static_cast<int>(ids->size()) && (*ids)[pick] >= 0)
+            stats->countAbility(static_cast<uint32_t>((*ids)[pick]));
+        return pick;
+    };
+}
+
+// Plays one seeded duel between roster[a] and roster[b] and records it.
+inline void recordDuel(DuelStats& stats, const std::vector<Fighter>& roster,
+                       const std::vector<std::vector<int32_t>>& ids,
+                       uint32_t a, uint32_t b, const DuelController& c1, const DuelController& c2, uint64_t seed) {
+    DuelOutcome o = simulateDuel(roster[a], roster[b], countingController(c1, &ids[a], &stats),
+                                 countingController(c2, &ids[b], &stats), seed);
+    stats.record(a, b, o, roster[a].getMaxHP(), roster[b].getMaxHP());
+}
+
+inline void printDuelSummary(const DuelStats& s) {
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Duels: " << s.duels() << "  Draws: " << s.draws()
+              << " (" << (s.duels() ? 100.0 * s.draws() / s.duels() : 0.0) << "%)\n";
+    std::cout << "Duel length (rounds): p50 " << s.lengthQuantile(0.50) << "  p95 " << s.lengthQuantile(0.95)
+              << "  p99 " << s.lengthQuantile(0.99) << "\n";
+    std::cout << "Winner HP left (% of max): p50 " << s.hpLeftQuantile(0.50) << "  p95 " << s.hpLeftQuantile(0.95)
+              << "  p99 " << s.hpLeftQuantile(0.99) << "\n";
+    std::vector<std::string> names = abilityNames();
+    uint64_t total = 0;
+    for(uint32_t a = 0; a < s.abilities(); ++a) total += s.uses(a);
+    std::cout << "Ability usage:\n";
+    for(uint32_t a = 0; a < s.abilities() && a < names.size(); ++a) {
+        std::cout << "  " << std::left << std::setw(22) << names[a] << std::right << std::setw(14) << s.uses(a)
+                  << "  " << std::setw(5) << (total ? 100.0 * s.uses(a) / total : 0.0) << "%\n";
+    }
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+inline void printDuelStats(const DuelStats& s, const std::vector<std::string>& fighters) {
+    std::cout << "\n-----------------------------DUEL STATISTICS-------------------------------\n";
+    std::cout << std::fixed << std::setprecision(1);
+    for(const auto& pr : s.pairingList()) {
+        uint32_t i = pr.first, j = pr.second;
+        if(i == j || !s.games(i, j)) continue;
+        auto ci = s.winRateInterval(i, j);
+        std::cout << std::left << std::setw(28) << (fighters[i] + " vs " + fighters[j]) << std::right
+                  << std::setw(12) << s.games(i, j) << " games  "
+                  << std::setw(5) << 100.0 * s.wins(i, j) / s.games(i, j) << "% wins  "
+                  << std::setw(5) << 100.0 * s.draws(i, j) / s.games(i, j) << "% draws  95% CI ["
+                  << 100.0 * ci.first << ", " << 100.0 * ci.second << "]\n";
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << "---------------------------------------------------------------------------\n";
+    printDuelSummary(s);
+}
+
+// Random-play duels over random roster pairings. Each thread records into
+// its own DuelStats and folds it into the shared result whenever it holds
+// kFlushPairings pairs, so per-thread memory stays bounded however large
+// the roster is.
+inline DuelStats collectDuelStats(uint64_t duels, uint64_t seed = 1,
+                                  unsigned threads = std::thread::hardware_concurrency()) {
+    std::vector<std::string> names = rosterNames();
+    std::vector<Fighter> roster;
+    for(const auto& n : names) roster.push_back(getFighter(n));
+    std::vector<std::vector<int32_t>> ids = learnSetIds(roster);
+    uint32_t n = static_cast<uint32_t>(roster.size());
+    uint32_t abilities = static_cast<uint32_t>(g_abilities().size());
+    if(!threads) threads = 1;
+
+    const size_t kFlushPairings = 4096;
+    DuelStats total(n, abilities);
+    if(n == 0) return total;
+    std::mutex totalLock;
+    auto work = [&](unsigned t) {
+        DuelStats part(n, abilities);
+        auto flush = [&] {
+            std::lock_guard<std::mutex> hold(totalLock);
+            total.merge(part);
+            part.clear();
+        };
+        for(uint64_t k = duels * t / threads; k < duels * (t + 1) / threads; ++k) {
+            DuelRng pick(mixSeed(seed, k));
+            uint32_t a = static_cast<uint32_t>(pick.below(static_cast<int>(n)));
+            uint32_t b = static_cast<uint32_t>(pick.below(static_cast<int>(n)));
+            recordDuel(part, roster, ids, a, b, randomController, randomController, pick.next());
+            if(part.pairings() >= kFlushPairings) flush();
+        }
+        flush();
+    };
+    std::vector<std::thread> pool;
+    for(unsigned t = 1; t < threads; ++t) pool.emplace_back(work, t);
+    work(0);
+    for(auto& th : pool) th.join();
+    return total;
+}
+
+inline void runDuelStats(uint64_t duels) {
+    std::vector<std::string> names = rosterNames();
+    if(names.empty()) {
+        std::cout << "No fighters available!\n";
+        return;
+    }
+    printDuelStats(collectDuelStats(duels), names);
+}
+
+#define STATS(duels) ,false)){} runDuelStats(duels); if(false){}else if((_FInit_{"_END_","Rushdown",1}
+
+#endif
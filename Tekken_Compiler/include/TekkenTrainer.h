@@ -0,0 +1,278 @@
+#ifndef TEKKEN_TRAINER_H
+#define TEKKEN_TRAINER_H
+
+#include "Tekken.h"
+
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+// Self-play trainer for per-fighter move policies. Each fighter gets a
+// tabular action-value function over a discretised duel state:
+//
+//   own HP (5 buckets) x enemy HP (5) x enemy out of ring (2)
+//   x round (4: 1-3, 4-10, 11-30, 31+) x own pending FOR/AFTER effects (2)
+//
+// Training runs Monte Carlo self-play rollouts through simulateDuel() on
+// several threads. During an epoch the value tables are read-only; every
+// thread accumulates returns into its own shard and the shards are folded
+// into the tables in thread order once the epoch ends.
+
+static const int kPolicyStates = 5 * 5 * 2 * 4 * 2;
+
+inline int policyState(const Fighter& self, const Fighter& foe, int round, const ActionContext& ctx) {
+    auto hpBucket = [](const Fighter& f) {
+        int b = f.getMaxHP() > 0 ? f.getHP() * 5 / f.getMaxHP() : 0;
+        return b < 0 ? 0 : (b > 4 ? 4 : b);
+    };
+    int r = round <= 3 ? 0 : (round <= 10 ? 1 : (round <= 30 ? 2 : 3));
+    int s = hpBucket(self);
+    s = s * 5 + hpBucket(foe);
+    s = s * 2 + (foe.isOutOfRing() ? 1 : 0);
+    s = s * 4 + r;
+    s = s * 2 + (ctx.pending() ? 1 : 0);
+    return s;
+}
+
+struct FighterPolicy {
+    int actions = 0;
+    std::vector<float> q;    // q[state * actions + action]
+
+    int best(int state) const {
+        int pick = 0;
+        for(int a = 1; a < actions; ++a)
+            if(q[state * actions + a] > q[state * actions + pick]) pick = a;
+        return pick;
+    }
+};
+
+class TrainedPolicy {
+    std::map<std::string, FighterPolicy> fighters_;
+
+public:
+    FighterPolicy& add(const std::string& name, int actions) {
+        FighterPolicy& p = fighters_[name];
+        p.actions = actions;
+        p.q.assign(static_cast<size_t>(kPolicyStates) * actions, 0.0f);
+        return p;
+    }
+
+    const FighterPolicy* find(const std::string& name) const {
+        auto it = fighters_.find(name);
+        return it == fighters_.end() ? nullptr : &it->second;
+    }
+
+    // Greedy controller; falls back to a random move for unknown fighters.
+    DuelController controller() const {
+        const TrainedPolicy* self = this;
+        return [self](const Fighter& me, const Fighter& foe, int round, const ActionContext& ctx, DuelRng& rng) {
+            const FighterPolicy* p = self->find(me.getName());
+            if(!p || p->actions != static_cast<int>(me.getAbilities().size()))
+                return randomController(me, foe, round, ctx, rng);
+            return p->best(policyState(me, foe, round, ctx));
+        };
+    }
+
+    void save(const std::string& path) const {
+        std::ofstream out(path);
+        if(!out) throw std::runtime_error("Cannot write policy: " + path);
+        out << "tekken-policy 1 " << kPolicyStates << "\n";
+        out << std::setprecision(std::numeric_limits<float>::max_digits10);
+        for(const auto& e : fighters_) {
+            out << "fighter " << e.second.actions << " " << e.first << "\n";
+            for(int s = 0; s < kPolicyStates; ++s) {
+                for(int a = 0; a < e.second.actions; ++a) out << (a ? " " : "") << e.second.q[s * e.second.actions + a];
+                out << "\n";
+            }
+        }
+        if(!out) throw std::runtime_error("Cannot write policy: " + path);
+    }
+
+    void load(const std::string& path) {
+        std::ifstream in(path);
+        std::string magic, kw, name;
+        int version = 0, states = 0, actions = 0;
+        if(!(in >> magic >> version >> states) || magic != "tekken-policy" || version != 1 || states != kPolicyStates)
+            throw std::runtime_error("Not a policy file: " + path);
+        fighters_.clear();
+        while(in >> kw) {
+            if(kw != "fighter" || !(in >> actions) || actions < 0 || !std::getline(in >> std::ws, name))
+                throw std::runtime_error("Corrupt policy file: " + path);
+            FighterPolicy& p = add(name, actions);
+            for(float& v : p.q) if(!(in >> v)) throw std::runtime_error("Corrupt policy file: " + path);
+        }
+    }
+};
+
+struct TrainerOptions {
+    uint64_t episodes = 200000;
+    int epochs = 40;
+    float alpha = 0.3f;          // step towards the epoch's mean return
+    float epsilonStart = 0.3f;
+    float epsilonEnd = 0.05f;
+    float discount = 0.98f;      // per own move, favours faster wins
+    unsigned threads = std::thread::hardware_concurrency();
+    uint64_t seed = 1;
+};
+
+class PolicyTrainer {
+    struct Step { int state; int action; };
+    struct Shard { std::vector<std::vector<double>> sum; std::vector<std::vector<uint32_t>> count; };
+
+    std::vector<std::string> names_;
+    std::vector<Fighter> roster_;
+    TrainedPolicy policy_;
+    std::vector<FighterPolicy*> tables_;
+    TrainerOptions opt_;
+
+    void record(Shard& shard, int f, const std::vector<Step>& steps, double reward) const {
+        double g = reward;
+        int actions = tables_[f]->actions;
+        for(size_t k = steps.size(); k-- > 0;) {
+            size_t i = static_cast<size_t>(steps[k].state) * actions + steps[k].action;
+            shard.sum[f][i] += g;
+            shard.count[f][i]++;
+            g *= opt_.discount;
+        }
+    }
+
+    void rollouts(Shard& shard, uint64_t first, uint64_t last, float epsilon, uint64_t epochSeed) const {
+        std::vector<Step> steps[2];
+        for(uint64_t e = first; e < last; ++e) {
+            DuelRng pick(mixSeed(epochSeed, e));
+            int side[2] = {pick.below(static_cast<int>(roster_.size())), pick.below(static_cast<int>(roster_.size()))};
+            steps[0].clear(); steps[1].clear();
+
+            auto make = [&](int who) -> DuelController {
+                const FighterPolicy* p = tables_[side[who]];
+                std::vector<Step>* out = &steps[who];
+                return [p, out, epsilon](const Fighter& me, const Fighter& foe, int round, const ActionContext& ctx, DuelRng& rng) {
+                    if(p->actions == 0) return -1;
+                    int s = policyState(me, foe, round, ctx);
+                    int a = (rng.next() % 10000) < epsilon * 10000 ? rng.below(p->actions) : p->best(s);
+                    out->push_back({s, a});
+                    return a;
+                };
+            };
+            DuelOutcome o = simulateDuel(roster_[side[0]], roster_[side[1]], make(0), make(1), pick.next());
+            double r1 = o.winner == 1 ? 1.0 : (o.winner == 2 ? -1.0 : 0.0);
+            record(shard, side[0], steps[0], r1);
+            record(shard, side[1], steps[1], -r1);
+        }
+    }
+
+public:
+    explicit PolicyTrainer(const TrainerOptions& opt = TrainerOptions()) : opt_(opt) {
+        if(!opt_.threads) opt_.threads = 1;
+        if(opt_.epochs < 1) opt_.epochs = 1;
+        names_ = rosterNames();
+        for(const auto& n : names_) {
+            roster_.push_back(getFighter(n));
+            tables_.push_back(&policy_.add(n, static_cast<int>(roster_.back().getAbilities().size())));
+        }
+    }
+
+    PolicyTrainer(const PolicyTrainer&) = delete;
+    PolicyTrainer& operator=(const PolicyTrainer&) = delete;
+
+    const TrainedPolicy& policy() const { return policy_; }
+
+    // Plays exactly opt.episodes rollouts spread over the epochs and returns
+    // how many were played.
+    uint64_t train() {
+        if(roster_.empty()) return 0;
+        uint64_t played = 0;
+        std::vector<Shard> shards(opt_.threads);
+        for(auto& sh : shards) {
+            sh.sum.resize(roster_.size());
+            sh.count.resize(roster_.size());
+        }
+
+        for(int epoch = 0; epoch < opt_.epochs; ++epoch) {
+            float t = opt_.epochs > 1 ? static_cast<float>(epoch) / (opt_.epochs - 1) : 1.0f;
+            float epsilon = opt_.epsilonStart + (opt_.epsilonEnd - opt_.epsilonStart) * t;
+            uint64_t epochSeed = mixSeed(opt_.seed, static_cast<uint64_t>(epoch));
+            uint64_t perEpoch = opt_.episodes * (epoch + 1) / opt_.epochs - opt_.episodes * epoch / opt_.epochs;
+            played += perEpoch;
+            for(auto& sh : shards) {
+                for(size_t f = 0; f < roster_.size(); ++f) {
+                    sh.sum[f].assign(tables_[f]->q.size(), 0.0);
+                    sh.count[f].assign(tables_[f]->q.size(), 0);
+                }
+            }
+
+            std::vector<std::thread> pool;
+            for(unsigned th = 1; th < opt_.threads; ++th) {
+                pool.emplace_back([&, th]() {
+                    rollouts(shards[th], perEpoch * th / opt_.threads, perEpoch * (th + 1) / opt_.threads, epsilon, epochSeed);
+                });
+            }
+            rollouts(shards[0], 0, perEpoch / opt_.threads, epsilon, epochSeed);
+            for(auto& th : pool) th.join();
+
+            for(size_t f = 0; f < roster_.size(); ++f) {
+                FighterPolicy& p = *tables_[f];
+                for(size_t i = 0; i < p.q.size(); ++i) {
+                    double sum = 0.0;
+                    uint64_t count = 0;
+                    for(const auto& sh : shards) { sum += sh.sum[f][i]; count += sh.count[f][i]; }
+                    if(count) p.q[i] += opt_.alpha * static_cast<float>(sum / count - p.q[i]);
+                }
+            }
+        }
+        return played;
+    }
+
+    // Share of duels the greedy policy wins against random play, over
+    // random pairings with the policy seated on either side.
+    double evaluate(uint64_t duels, uint64_t seed = 99) const {
+        if(roster_.empty() || duels == 0) return 0.0;
+        DuelController greedy = policy_.controller();
+        uint64_t wins = 0;
+        for(uint64_t k = 0; k < duels; ++k) {
+            DuelRng pick(mixSeed(seed, k));
+            const Fighter& a = roster_[pick.below(static_cast<int>(roster_.size()))];
+            const Fighter& b = roster_[pick.below(static_cast<int>(roster_.size()))];
+            bool first = (k & 1) == 0;
+            DuelOutcome o = first ? simulateDuel(a, b, greedy, randomController, pick.next())
+                                  : simulateDuel(b, a, randomController, greedy, pick.next());
+            if(o.winner == (first ? 1 : 2)) wins++;
+        }
+        return static_cast<double>(wins) / duels;
+    }
+};
+
+inline void trainPolicy(uint64_t episodes, const std::string& path) {
+    if(rosterNames().empty()) {
+        std::cout << "No fighters available!\n";
+        return;
+    }
+    TrainerOptions opt;
+    opt.episodes = episodes;
+    PolicyTrainer trainer(opt);
+    double before = trainer.evaluate(4000);
+    uint64_t played = trainer.train();
+    double after = trainer.evaluate(4000);
+    trainer.policy().save(path);
+    std::cout << std::fixed << std::setprecision(1)
+              << "Trained " << played << " self-play duels. Win rate vs random: "
+              << 100.0 * before << "% -> " << 100.0 * after << "%\n"
+              << "Policy written to " << path << "\n";
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+// Player2 is driven by a policy file written by trainPolicy().
+inline void runPolicyDuel(const std::string& path) {
+    static TrainedPolicy policy;
+    policy.load(path);
+    g_player2Controller() = policy.controller();
+    runDuel();
+    g_player2Controller() = nullptr;
+}
+
+#define TRAIN_POLICY(episodes, path) ,false)){} trainPolicy(episodes, path); if(false){}else if((_FInit_{"_END_","Rushdown",1}
+#define AI_DUEL(path) ,false)){} runPolicyDuel(path); if(false){}else if((_FInit_{"_END_","Rushdown",1}
+
+#endif
@@ -0,0 +1,19 @@
+#include "../include/TekkenRoster.h"
+
+int main(int argc, char** argv) {
+    if(argc != 3) {
+        std::cerr << "usage: tekken_rosterc <roster.txt> <image.tkr>\n";
+        return 2;
+    }
+    try {
+        compileRosterFile(argv[1], argv[2]);
+        RosterImage img;
+        img.open(argv[2]);
+        std::cout << argv[2] << ": " << img.fighterCount() << " fighters, "
+                  << img.abilityCount() << " abilities\n";
+    } catch(const std::exception& e) {
+        std::cerr << "tekken_rosterc: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}